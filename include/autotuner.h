@@ -0,0 +1,126 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "kernel.h"
+#include "index_seq.h"
+#include "plan_cache.h"
+#include "profiler.h"
+#include "thread_pool.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+struct TunedConfig {
+    std::size_t blockDim{1};
+    std::size_t tileSize{0};
+    double seconds{0.0};        // 调优时测得的最快耗时
+};
+
+struct TuneCandidates {
+    std::vector<std::size_t> blockDims;     // 为空时取 1, 2, 4, ... 直到 pool.Size()，以及 pool.Size() 与其 2 倍
+    std::vector<std::size_t> tileSizes{0, 4096, 16384, 65536};
+    std::size_t repeat{3};
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Autotuner：按 kernel 签名与 count 档位（floor(log2(count))）记录最快的 blockDim x tileSize
+// 以 AUTO_BLOCK_DIM 启动的 kernel（如 ElemWise::RunAuto）在启动时查表，未调优过的组合使用 pool.Size() 个 block
+// 调优结果存放在 PlanCache 中，以当前 CPU 的 IsaVariant 区分；Default() 在首次使用时映射环境变量
+// ASL_PLAN_CACHE 指向的计划文件，因此重启后无需重新调优
+class Autotuner {
+public:
+    Autotuner() : isa_(DetectIsa()) {}
+
+    static std::size_t CountBucket(std::size_t count);
+
+    // 查表；找不到时返回 false
+    bool Find(std::string_view signature, std::size_t count, TunedConfig& config) const;
+
+    void Set(std::string_view signature, std::size_t bucket, const TunedConfig& config,
+             const PlanLayout& layout = PlanLayout());
+
+    std::size_t Size() const;
+
+    void Clear();
+
+    // 把 AUTO_BLOCK_DIM 的启动配置替换为调优结果
+    LaunchConfig Resolve(std::string_view signature, std::size_t count, const LaunchConfig& config) const;
+
+    // 对每个候选组合在 pool 上以 count 个元素执行 repeat 次，记录并返回最快的组合
+    // launch(config) 需要按给定配置完成一次完整的 kernel 启动
+    TunedConfig Tune(std::string_view signature, ThreadPool& pool, std::size_t count,
+                     const std::function<void(const LaunchConfig&)>& launch,
+                     const TuneCandidates& candidates = TuneCandidates(),
+                     const PlanLayout& layout = PlanLayout());
+
+    // 在临时缓冲区上调优不带属性参数的 KERNEL（地址约定见 kernel.h）
+    template <typename KERNEL>
+    TunedConfig Tune(ThreadPool& pool, std::size_t count, const TuneCandidates& candidates = TuneCandidates()) {
+        std::vector<unsigned char> inputs(KERNEL::IN_BYTES * count, 1);
+        std::vector<unsigned char> outputs(KERNEL::OUT_BYTES * count, 0);
+        KERNEL kernel;
+        return Tune(KERNEL::Signature(), pool, count, [&](const LaunchConfig& config) {
+            RunPacked(kernel, config, inputs.data(), outputs.data(), count,
+                      MakeIndexSequence<KERNEL::INPUT_COUNT>{}, MakeIndexSequence<KERNEL::OUTPUT_COUNT>{});
+        }, candidates, LayoutOf<KERNEL>());
+    }
+
+    template <typename KERNEL>
+    static PlanLayout LayoutOf() {
+        PlanLayout layout;
+        layout.inputCount = KERNEL::INPUT_COUNT;
+        layout.outputCount = KERNEL::OUTPUT_COUNT;
+        for (std::size_t i = 0; i < KERNEL::INPUT_COUNT && i < PLAN_MAX_TENSORS; ++i) {
+            layout.offsets[i] = KERNEL::IN_OFFSETS[i];
+        }
+        for (std::size_t i = 0; i < KERNEL::OUTPUT_COUNT && KERNEL::INPUT_COUNT + i < PLAN_MAX_TENSORS; ++i) {
+            layout.offsets[KERNEL::INPUT_COUNT + i] = KERNEL::OUT_OFFSETS[i];
+        }
+        return layout;
+    }
+
+    // 保存为 PlanCache 二进制文件
+    bool Save(const std::string& path) const;
+
+    // 映射计划文件，之后 Set 的结果覆盖文件中的同键计划；文件不存在或格式不符时返回 false
+    bool Load(const std::string& path);
+
+    IsaVariant Isa() const {
+        return isa_;
+    }
+
+    PlanCache& Cache() {
+        return cache_;
+    }
+
+    static Autotuner& Default();
+
+private:
+    template <typename KERNEL, std::size_t... Is, std::size_t... Os>
+    static void RunPacked(KERNEL& kernel, const LaunchConfig& config, Addr in, Addr out, std::size_t count,
+                          IndexSequence<Is...>, IndexSequence<Os...>) {
+        kernel.RunWithConfig(config, ((void)Is, in)..., ((void)Os, out)..., count);
+    }
+
+private:
+    IsaVariant isa_;
+    PlanCache cache_;
+};
+
+// 为库中预先实例化的全部 ElemWise kernel 在每个 count 上调优（见 kernel_ops.h）
+void TunePrebuiltKernels(Autotuner& tuner, ThreadPool& pool, const std::vector<std::size_t>& counts,
+                         const TuneCandidates& candidates = TuneCandidates());
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef CACHING_ALLOCATOR_H
+#define CACHING_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include "kernel.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 分桶策略：按 2 的幂或 1.25 倍递增划分块大小
+enum class BucketPolicy {
+    POWER_OF_TWO,
+    GEOMETRIC_1_25,
+};
+
+struct CachingAllocatorConfig {
+    BucketPolicy policy{BucketPolicy::POWER_OF_TWO};
+    std::size_t threadCacheBlocks{8};          // 每个线程每个桶最多缓存的块数，超出后放回全局缓存
+    std::size_t maxCachedBytes{1ull << 32};    // 全局缓存与各线程缓存合计的上限，超出后直接归还系统
+};
+
+struct AllocatorStats {
+    std::size_t hits{0};            // 从缓存中取得的分配次数
+    std::size_t misses{0};          // 需要向系统申请的分配次数
+    std::size_t bytesCached{0};     // 缓存中空闲块的字节数（含各线程缓存，及 ReleaseCached 后其他线程尚未归还的块）
+    std::size_t bytesInUse{0};      // 已交给使用方的块字节数（按桶大小计）
+    std::size_t bytesRequested{0};  // 使用方实际请求的字节数
+
+    // 内部碎片率：桶大小超出请求大小的部分占已分配字节的比例
+    double Fragmentation() const {
+        return bytesInUse == 0 ? 0.0 : 1.0 - static_cast<double>(bytesRequested) / bytesInUse;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// CachingAllocator：为 ElemWise 的 Addr 缓冲区提供分桶缓存
+// 释放的块先进入当前线程的空闲链表，满了再进入全局链表；分配时依次查找两者
+// 返回的地址按 64 字节对齐
+class CachingAllocator {
+public:
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    explicit CachingAllocator(const CachingAllocatorConfig& config = CachingAllocatorConfig());
+    ~CachingAllocator();
+
+    CachingAllocator(const CachingAllocator&) = delete;
+    CachingAllocator& operator=(const CachingAllocator&) = delete;
+
+    Addr Allocate(std::size_t bytes);
+    void Free(Addr addr);
+
+    // 请求大小对应的桶大小；超过最大桶时返回 0，表示不缓存
+    std::size_t BucketSize(std::size_t bytes) const;
+
+    // 把全局缓存和当前线程缓存中的空闲块归还系统；其他线程的缓存只被标记为过期，在该线程下次调用
+    // Allocate / Free 时才归还系统（线程退出时放回全局缓存）。在此之前这些块仍由该线程持有并计入
+    // Stats().bytesCached，因此之后不再调用分配器的空闲线程（如线程池的工作线程）会一直占用其缓存，
+    // 总量仍受 maxCachedBytes 限制
+    void ReleaseCached();
+
+    AllocatorStats Stats() const;
+
+    static CachingAllocator& Default();
+
+    struct Shared;
+
+private:
+    std::shared_ptr<Shared> shared_;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+struct CachedDeleter {
+    CachingAllocator* allocator;
+
+    void operator()(unsigned char* addr) const {
+        allocator->Free(addr);
+    }
+};
+
+using CachedBuffer = std::unique_ptr<unsigned char[], CachedDeleter>;
+
+inline CachedBuffer AllocateBuffer(std::size_t bytes, CachingAllocator& allocator = CachingAllocator::Default()) {
+    return CachedBuffer(allocator.Allocate(bytes), CachedDeleter{&allocator});
+}
+
+}
+
+#endif
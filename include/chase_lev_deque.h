@@ -0,0 +1,128 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef CHASE_LEV_DEQUE_H
+#define CHASE_LEV_DEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// ChaseLevDeque：工作窃取用的无锁双端队列（Chase & Lev 2005，内存序按 Lê et al. 2013）
+// 只有所属线程可以调用 Push / Pop（在底端 LIFO 操作），任意线程都可以调用 Steal（从顶端 FIFO 窃取）
+// 容量不足时翻倍扩容，旧数组可能仍在被窃取线程读取，因此保留到析构时再释放
+template <typename T>
+class ChaseLevDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "ChaseLevDeque element should be trivially copyable!");
+
+    struct Array {
+        explicit Array(std::size_t cap) : capacity(cap), slots(new std::atomic<T>[cap]) {}
+
+        T Load(std::int64_t i) const {
+            return slots[static_cast<std::size_t>(i) & (capacity - 1)].load(std::memory_order_acquire);
+        }
+
+        void Store(std::int64_t i, T value) {
+            slots[static_cast<std::size_t>(i) & (capacity - 1)].store(value, std::memory_order_release);
+        }
+
+        Array* Grow(std::int64_t top, std::int64_t bottom) const {
+            auto* array = new Array(capacity * 2);
+            for (std::int64_t i = top; i < bottom; ++i) {
+                array->Store(i, Load(i));
+            }
+            return array;
+        }
+
+        const std::size_t capacity;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+public:
+    // capacity 必须是 2 的幂
+    explicit ChaseLevDeque(std::size_t capacity = 64) {
+        arrays_.emplace_back(new Array(capacity));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    void Push(T value) {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        Array* array = array_.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<std::int64_t>(array->capacity) - 1) {
+            arrays_.emplace_back(array->Grow(top, bottom));
+            array = arrays_.back().get();
+            array_.store(array, std::memory_order_release);
+        }
+        array->Store(bottom, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    bool Pop(T& value) {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        T candidate = array->Load(bottom);
+        if (top == bottom) {
+            // 只剩最后一个元素，与窃取线程竞争
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return false;
+            }
+        }
+        value = candidate;
+        return true;
+    }
+
+    bool Steal(T& value) {
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return false;
+        }
+        Array* array = array_.load(std::memory_order_acquire);
+        T candidate = array->Load(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        value = candidate;
+        return true;
+    }
+
+    // 近似大小，仅用于统计与调试
+    std::size_t Size() const {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+    }
+
+private:
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<Array*> array_{nullptr};
+    std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef COMPACT_TUPLE_H
+#define COMPACT_TUPLE_H
+
+#include <utility>
+#include "tuple.h"
+#include "index_seq.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// CompactLayout 元结构：按对齐要求降序（稳定）排列元素的物理存储位置
+// toLogical[P] : 物理位置 P 上存放的逻辑元素下标
+// toPhysical[N]: 逻辑元素 N 所在的物理位置
+template <typename... Ts>
+struct CompactLayout {
+    static constexpr std::size_t SIZE = sizeof...(Ts);
+
+    struct Order {
+        std::size_t toLogical[SIZE + 1];
+        std::size_t toPhysical[SIZE + 1];
+    };
+
+private:
+    static constexpr Order MakeOrder() {
+        const std::size_t aligns[SIZE + 1] = { alignof(Ts)..., 0 };
+        Order order{};
+        for (std::size_t i = 0; i < SIZE; ++i) {
+            order.toLogical[i] = i;
+        }
+        // 插入排序：元素个数很少，且稳定排序可保证相同对齐的元素保持声明顺序
+        for (std::size_t i = 1; i < SIZE; ++i) {
+            std::size_t cur = order.toLogical[i];
+            std::size_t j = i;
+            while (j > 0 && aligns[order.toLogical[j - 1]] < aligns[cur]) {
+                order.toLogical[j] = order.toLogical[j - 1];
+                --j;
+            }
+            order.toLogical[j] = cur;
+        }
+        for (std::size_t i = 0; i < SIZE; ++i) {
+            order.toPhysical[order.toLogical[i]] = i;
+        }
+        return order;
+    }
+
+public:
+    static constexpr Order ORDER = MakeOrder();
+
+    template <std::size_t N>
+    static constexpr std::size_t PHYSICAL = ORDER.toPhysical[N];
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// CompactTuple：逻辑下标与 Tuple 一致，物理存储按对齐降序重排以减少填充
+// 例如 Tuple<char, double, char, int> 占 24 字节，而 CompactTuple 只占 16 字节
+template <typename... Ts>
+class CompactTuple {
+    using Layout = CompactLayout<Ts...>;
+    using Types  = TypeList<Ts...>;
+
+    template <typename Seq>
+    struct StorageOf;
+
+    template <std::size_t... Ps>
+    struct StorageOf<IndexSequence<Ps...>> {
+        using type = Tuple<typename TypeList_Get<Types, Layout::ORDER.toLogical[Ps]>::type...>;
+    };
+
+    using Seq = MakeIndexSequence<sizeof...(Ts)>;
+
+public:
+    using Storage = typename StorageOf<Seq>::type;
+
+    CompactTuple() : storage() {}
+    CompactTuple(Ts... ts) : CompactTuple(ForwardAsTuple(std::move(ts)...), Seq{}) {}
+
+    Storage storage;
+
+private:
+    template <typename RefTuple, std::size_t... Ps>
+    CompactTuple(RefTuple&& refs, IndexSequence<Ps...>)
+    : storage(asl::forward<typename TypeList_Get<Types, Layout::ORDER.toLogical[Ps]>::type>(
+                TupleElemGet<Layout::ORDER.toLogical[Ps]>(refs))...) {
+    }
+};
+
+template <>
+class CompactTuple<> {
+public:
+    using Storage = Tuple<>;
+    Storage storage;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+template <typename... Ts>
+struct TupleSize<CompactTuple<Ts...>> {
+    static constexpr size_t value = sizeof...(Ts);
+};
+
+template <std::size_t N, typename... Ts>
+struct TupleElemType<N, CompactTuple<Ts...>> {
+    using type = typename TupleElemType<N, Tuple<Ts...>>::type;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 按逻辑下标获取 CompactTuple 元素的引用
+template <std::size_t N, typename... Ts>
+typename TupleElemType<N, Tuple<Ts...>>::type& TupleElemGet(CompactTuple<Ts...>& tuple) {
+    return TupleElemGet<CompactLayout<Ts...>::template PHYSICAL<N>>(tuple.storage);
+}
+
+template <std::size_t N, typename... Ts>
+const typename TupleElemType<N, Tuple<Ts...>>::type& TupleElemGet(const CompactTuple<Ts...>& tuple) {
+    return TupleElemGet<CompactLayout<Ts...>::template PHYSICAL<N>>(tuple.storage);
+}
+
+template <std::size_t N, typename... Ts>
+typename TupleElemType<N, Tuple<Ts...>>::type&& TupleElemGet(CompactTuple<Ts...>&& tuple) {
+    return TupleElemGet<CompactLayout<Ts...>::template PHYSICAL<N>>(std::move(tuple.storage));
+}
+
+}
+
+#endif
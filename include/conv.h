@@ -0,0 +1,276 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef CONV_H
+#define CONV_H
+
+#include <algorithm>
+#include <cstddef>
+#include <typeinfo>
+#include "kernel.h"
+#include "matmul.h"
+#include "profiler.h"
+#include "thread_pool.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 二维卷积的形状，y = conv(x, w)
+// NCHW：x 为 N x C x H x W，w 为 OC x IC x KH x KW（OIHW），y 为 N x OC x OH x OW
+// NHWC：x 为 N x H x W x C，w 为 KH x KW x IC x OC（HWIO），y 为 N x OH x OW x OC
+enum class ConvLayout {
+    NCHW,
+    NHWC,
+};
+
+struct Conv2dShape {
+    std::size_t batch;
+    std::size_t inChannels;
+    std::size_t height;
+    std::size_t width;
+    std::size_t outChannels;
+    std::size_t kernelH;
+    std::size_t kernelW;
+    std::size_t strideH{1};
+    std::size_t strideW{1};
+    std::size_t padH{0};
+    std::size_t padW{0};
+    std::size_t dilationH{1};
+    std::size_t dilationW{1};
+    ConvLayout layout{ConvLayout::NCHW};
+
+    std::size_t OutH() const {
+        return OutSize(height, kernelH, strideH, padH, dilationH);
+    }
+
+    std::size_t OutW() const {
+        return OutSize(width, kernelW, strideW, padW, dilationW);
+    }
+
+    std::size_t InputSize() const {
+        return batch * inChannels * height * width;
+    }
+
+    std::size_t WeightSize() const {
+        return outChannels * inChannels * kernelH * kernelW;
+    }
+
+    std::size_t OutputSize() const {
+        return batch * outChannels * OutH() * OutW();
+    }
+
+private:
+    static std::size_t OutSize(std::size_t in, std::size_t kernel, std::size_t stride, std::size_t pad,
+                               std::size_t dilation) {
+        std::size_t span = dilation * (kernel - 1) + 1;
+        return in + 2 * pad < span ? 0 : (in + 2 * pad - span) / stride + 1;
+    }
+};
+
+namespace detail {
+    // 输出位置 (oh, ow) 对应的输入窗口左上角，可能落在 padding 中（为负）
+    struct ConvWindow {
+        std::ptrdiff_t ih;
+        std::ptrdiff_t iw;
+    };
+
+    inline ConvWindow WindowOf(const Conv2dShape& shape, std::size_t oh, std::size_t ow) {
+        return ConvWindow{static_cast<std::ptrdiff_t>(oh * shape.strideH) - static_cast<std::ptrdiff_t>(shape.padH),
+                          static_cast<std::ptrdiff_t>(ow * shape.strideW) - static_cast<std::ptrdiff_t>(shape.padW)};
+    }
+
+    // NCHW 的隐式 GEMM：每个 batch 一组 y[n](OC x OH*OW) = w(OC x IC*KH*KW) * im2col(x[n])
+    // B 的第 p 行为 (ic, kh, kw)，第 j 列为输出位置 (oh, ow)，在 PackB 时从 x 中即时取数
+    template <typename T>
+    struct ConvNchwSource {
+        const T* x;
+        const T* w;
+        T* y;
+        Conv2dShape shape;
+        std::size_t outH;
+        std::size_t outW;
+
+        std::size_t Batch() const { return shape.batch; }
+        std::size_t M() const { return shape.outChannels; }
+        std::size_t N() const { return outH * outW; }
+        std::size_t K() const { return shape.inChannels * shape.kernelH * shape.kernelW; }
+        std::size_t Ldc() const { return outH * outW; }
+        T* C(std::size_t batch) const { return y + batch * shape.outChannels * outH * outW; }
+
+        void PackA(T* packed, std::size_t mr, std::size_t, std::size_t ic, std::size_t mc,
+                   std::size_t pc, std::size_t kc) const {
+            const std::size_t k = K();
+            for (std::size_t ir = 0; ir < mc; ir += mr) {
+                std::size_t rows = std::min(mr, mc - ir);
+                for (std::size_t p = 0; p < kc; ++p) {
+                    for (std::size_t i = 0; i < mr; ++i) {
+                        *packed++ = i < rows ? w[(ic + ir + i) * k + pc + p] : T(0);
+                    }
+                }
+            }
+        }
+
+        void PackB(T* packed, std::size_t nr, std::size_t batch, std::size_t pc, std::size_t kc,
+                   std::size_t jc, std::size_t nc) const {
+            const std::size_t kernelSize = shape.kernelH * shape.kernelW;
+            const T* image = x + batch * shape.inChannels * shape.height * shape.width;
+            ConvWindow windows[64];
+            for (std::size_t jr = 0; jr < nc; jr += nr) {
+                std::size_t cols = std::min(nr, nc - jr);
+                for (std::size_t j = 0; j < cols; ++j) {
+                    std::size_t pos = jc + jr + j;
+                    windows[j] = WindowOf(shape, pos / outW, pos % outW);
+                }
+                // (ic, kh, kw) 随 p 递增逐位进位，避免每行做除法
+                std::size_t c = pc / kernelSize;
+                std::size_t kh = pc % kernelSize / shape.kernelW;
+                std::size_t kw = pc % shape.kernelW;
+                for (std::size_t p = 0; p < kc; ++p) {
+                    const T* plane = image + c * shape.height * shape.width;
+                    std::ptrdiff_t dh = static_cast<std::ptrdiff_t>(kh * shape.dilationH);
+                    std::ptrdiff_t dw = static_cast<std::ptrdiff_t>(kw * shape.dilationW);
+                    for (std::size_t j = 0; j < nr; ++j) {
+                        std::ptrdiff_t ih = windows[j].ih + dh;
+                        std::ptrdiff_t iw = windows[j].iw + dw;
+                        bool inside = j < cols && ih >= 0 && iw >= 0 && ih < static_cast<std::ptrdiff_t>(shape.height)
+                                   && iw < static_cast<std::ptrdiff_t>(shape.width);
+                        *packed++ = inside ? plane[ih * shape.width + iw] : T(0);
+                    }
+                    if (++kw == shape.kernelW) {
+                        kw = 0;
+                        if (++kh == shape.kernelH) {
+                            kh = 0;
+                            ++c;
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    // NHWC 的隐式 GEMM：y(N*OH*OW x OC) = im2col(x)(N*OH*OW x KH*KW*IC) * w(KH*KW*IC x OC)
+    // A 的第 i 行为输出位置 (n, oh, ow)，第 p 列为 (kh, kw, ic)，ic 变化最快，在 PackA 时从 x 中连续取数
+    template <typename T>
+    struct ConvNhwcSource {
+        const T* x;
+        const T* w;
+        T* y;
+        Conv2dShape shape;
+        std::size_t outH;
+        std::size_t outW;
+
+        std::size_t Batch() const { return 1; }
+        std::size_t M() const { return shape.batch * outH * outW; }
+        std::size_t N() const { return shape.outChannels; }
+        std::size_t K() const { return shape.kernelH * shape.kernelW * shape.inChannels; }
+        std::size_t Ldc() const { return shape.outChannels; }
+        T* C(std::size_t) const { return y; }
+
+        void PackA(T* packed, std::size_t mr, std::size_t, std::size_t ic, std::size_t mc,
+                   std::size_t pc, std::size_t kc) const {
+            const std::size_t channels = shape.inChannels;
+            const std::size_t rowStride = shape.width * channels;
+            const T* images[64];
+            ConvWindow windows[64];
+            for (std::size_t ir = 0; ir < mc; ir += mr) {
+                std::size_t rows = std::min(mr, mc - ir);
+                for (std::size_t i = 0; i < rows; ++i) {
+                    std::size_t pos = ic + ir + i;
+                    std::size_t n = pos / (outH * outW);
+                    pos %= outH * outW;
+                    images[i] = x + n * shape.height * rowStride;
+                    windows[i] = WindowOf(shape, pos / outW, pos % outW);
+                }
+                std::size_t c = pc % channels;
+                std::size_t kw = pc / channels % shape.kernelW;
+                std::size_t kh = pc / channels / shape.kernelW;
+                for (std::size_t p = 0; p < kc; ++p) {
+                    std::ptrdiff_t dh = static_cast<std::ptrdiff_t>(kh * shape.dilationH);
+                    std::ptrdiff_t dw = static_cast<std::ptrdiff_t>(kw * shape.dilationW);
+                    for (std::size_t i = 0; i < mr; ++i) {
+                        std::ptrdiff_t ih = windows[i].ih + dh;
+                        std::ptrdiff_t iw = windows[i].iw + dw;
+                        bool inside = i < rows && ih >= 0 && iw >= 0 && ih < static_cast<std::ptrdiff_t>(shape.height)
+                                   && iw < static_cast<std::ptrdiff_t>(shape.width);
+                        *packed++ = inside ? images[i][ih * rowStride + iw * channels + c] : T(0);
+                    }
+                    if (++c == channels) {
+                        c = 0;
+                        if (++kw == shape.kernelW) {
+                            kw = 0;
+                            ++kh;
+                        }
+                    }
+                }
+            }
+        }
+
+        void PackB(T* packed, std::size_t nr, std::size_t, std::size_t pc, std::size_t kc,
+                   std::size_t jc, std::size_t nc) const {
+            const std::size_t n = shape.outChannels;
+            for (std::size_t jr = 0; jr < nc; jr += nr) {
+                std::size_t cols = std::min(nr, nc - jr);
+                for (std::size_t p = 0; p < kc; ++p) {
+                    const T* row = w + (pc + p) * n + jc + jr;
+                    for (std::size_t j = 0; j < nr; ++j) {
+                        *packed++ = j < cols ? row[j] : T(0);
+                    }
+                }
+            }
+        }
+    };
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Conv2d：KernelType::CONV 的执行器，以隐式 GEMM 计算卷积，复用 Matmul 的分块、打包与微内核
+// im2col 矩阵从不整体生成：打包 kc 行的面板时才从 x 中按窗口取数（越界即 padding 处补零），
+// 额外内存只有与分块大小相关的打包缓冲区
+// 不支持分组卷积与 bias
+template <typename T>
+class Conv2d {
+public:
+    static constexpr KernelType TYPE = KernelType::CONV;
+
+    explicit Conv2d(const MatmulBlocking& blocking = MatmulBlocking()) : blocking_(blocking) {}
+
+    static const char* Signature() {
+        return typeid(Conv2d).name();
+    }
+
+    void Run(Addr x, Addr w, Addr y, const Conv2dShape& shape) {
+        RunWithConfig(LaunchConfig{}, x, w, y, shape);
+    }
+
+    // blockDim 为 AUTO_BLOCK_DIM 时取 Autotuner::Default() 中以输出元素数查到的调优结果，未调优时取 pool.Size()
+    void RunParallel(ThreadPool& pool, std::size_t blockDim, Addr x, Addr w, Addr y, const Conv2dShape& shape) {
+        RunWithConfig(LaunchConfig{&pool, blockDim}, x, w, y, shape);
+    }
+
+    void RunWithConfig(const LaunchConfig& config, Addr x, Addr w, Addr y, const Conv2dShape& shape) {
+        ScopedLaunch launch(Signature(), RecordKind::LAUNCH, shape.OutputSize(),
+                            (shape.InputSize() + shape.WeightSize()) * sizeof(T), shape.OutputSize() * sizeof(T));
+
+        const T* input = reinterpret_cast<const T*>(x);
+        const T* weight = reinterpret_cast<const T*>(w);
+        T* output = reinterpret_cast<T*>(y);
+        if (shape.layout == ConvLayout::NCHW) {
+            detail::ConvNchwSource<T> source{input, weight, output, shape, shape.OutH(), shape.OutW()};
+            BlockedGemm<T, detail::ConvNchwSource<T>>::Run(config, blocking_, source, T(0), Signature());
+        } else {
+            detail::ConvNhwcSource<T> source{input, weight, output, shape, shape.OutH(), shape.OutW()};
+            BlockedGemm<T, detail::ConvNhwcSource<T>>::Run(config, blocking_, source, T(0), Signature());
+        }
+    }
+
+    const MatmulBlocking& Blocking() const {
+        return blocking_;
+    }
+
+private:
+    MatmulBlocking blocking_;
+};
+
+}
+
+#endif
@@ -0,0 +1,371 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef ELEM_WISE_H
+#define ELEM_WISE_H
+
+#include <algorithm>
+#include <cstring>
+#include <typeinfo>
+#include <utility>
+#include "autotuner.h"
+#include "kernel.h"
+#include "perf_counters.h"
+#include "profiler.h"
+#include "simulator.h"
+#include "thread_pool.h"
+#include "tiling.h"
+#include "type_list.h"
+#include "unified_buffer.h"
+#include "tuple.h"
+#include "index_seq.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// ElemWise：逐元素 kernel 的执行器
+// Run(inAddrs..., outAddrs..., count, attrs...) 会把地址转换为 Tensor 后调用
+// OP(inTensors..., outTensors..., tempTensors..., count, attrs...)
+template <typename OP, typename INPUT_TYPES, typename OUTPUT_TYPES, typename TEMP_TYPES = Temp<>>
+class ElemWise {
+
+    static_assert(INPUT_TYPES::usage  == ParamType::INPUT, "INPUT_TYPES should be INPUT");
+    static_assert(OUTPUT_TYPES::usage == ParamType::OUTPUT, "OUTPUT_TYPES should be OUTPUT");
+    static_assert(TEMP_TYPES::usage   == ParamType::TEMP, "TEMP_TYPES should be TEMP");
+
+    using INPUTS  = typename INPUT_TYPES::types;
+    using OUTPUTS = typename OUTPUT_TYPES::types;
+    using TEMPS   = typename TEMP_TYPES::types;
+
+    using TILING     = KernelTiling<OP>;
+    using TilingData = typename TILING::Data;
+
+public:
+    // 每个 TypeList 的偏移表在编译期只计算一次，Run 中直接查表
+    static constexpr auto IN_OFFSETS  = TypeList_ByteOffsets<INPUTS>::value;
+    static constexpr auto OUT_OFFSETS = TypeList_ByteOffsets<OUTPUTS>::value;
+    static constexpr auto TEMP_OFFSETS = TypeList_ByteOffsets<TEMPS>::value;
+
+    static constexpr std::size_t INPUT_COUNT  = TypeList_Size<INPUTS>::value;
+    static constexpr std::size_t OUTPUT_COUNT = TypeList_Size<OUTPUTS>::value;
+    static constexpr std::size_t TEMP_COUNT   = TypeList_Size<TEMPS>::value;
+    static constexpr std::size_t ADDR_COUNT   = INPUT_COUNT + OUTPUT_COUNT;
+
+    // 每个元素读写的字节数与运算次数，用于 Profiler 计算带宽、roofline 分析与 Simulator 估算
+    // 输入输出全为整数时 FLOPS_PER_ELEM 为 0，OPS_PER_ELEM 仍为 OP 声明的运算次数
+    static constexpr std::size_t IN_BYTES  = TypeList_ByteOffsets<INPUTS>::total;
+    static constexpr std::size_t OUT_BYTES = TypeList_ByteOffsets<OUTPUTS>::total;
+    static constexpr double OPS_PER_ELEM = KernelFlops<OP>::value;
+    static constexpr double FLOPS_PER_ELEM =
+        HasFloatingPoint<INPUTS>::value || HasFloatingPoint<OUTPUTS>::value ? OPS_PER_ELEM : 0.0;
+
+    // 临时 Tensor 分配在执行线程的 UB 上，tile 个元素时占用的字节数（每个按 UB_ALIGN 对齐）
+    static constexpr std::size_t UbTempBytes(std::size_t tile) {
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < TEMP_COUNT; ++i) {
+            bytes += UbAlignUp((TEMP_OFFSETS[i + 1] - TEMP_OFFSETS[i]) * tile);
+        }
+        return bytes;
+    }
+
+    // 调优、统计使用的 kernel 签名
+    static const char* Signature() {
+        return typeid(ElemWise).name();
+    }
+
+    // 单 block 在调用线程上执行
+    template <typename... Args>
+    void Run(Args&&... args) {
+        RunWithConfig(LaunchConfig{}, std::forward<Args>(args)...);
+    }
+
+    // 多核执行：count 划分为 blockDim 个 block，第 b 个 block 由 pool 的第 b % Size() 个线程执行
+    // 各 block 使用 OP 的独立副本并发调用
+    template <typename... Args>
+    void RunParallel(ThreadPool& pool, std::size_t blockDim, Args&&... args) {
+        RunWithConfig(LaunchConfig{&pool, blockDim}, std::forward<Args>(args)...);
+    }
+
+    // 工作窃取执行：block 的初始归属与 RunParallel 相同（FirstTouch 的页仍然就近），
+    // 但每个 block 细分为 STEAL_CHUNKS_PER_BLOCK 个 chunk，先完成的线程会窃取落后 block 的剩余 chunk
+    template <typename... Args>
+    void RunStealing(ThreadPool& pool, std::size_t blockDim, Args&&... args) {
+        RunWithConfig(LaunchConfig{&pool, blockDim, LaunchSchedule::STEALING}, std::forward<Args>(args)...);
+    }
+
+    // blockDim 与 tileSize 取 Autotuner::Default() 中对应签名与 count 档位的调优结果
+    template <typename... Args>
+    void RunAuto(ThreadPool& pool, Args&&... args) {
+        RunWithConfig(LaunchConfig{&pool, AUTO_BLOCK_DIM}, std::forward<Args>(args)...);
+    }
+
+    // 按给定的启动配置执行
+    template <typename... Args>
+    void RunWithConfig(const LaunchConfig& config, Args&&... args) {
+
+        static_assert(sizeof...(Args) > ADDR_COUNT, "args size is wrong!");
+
+        auto argsTuple = ForwardAsTuple(std::forward<Args>(args)...);
+
+        std::size_t count = TupleElemGet<ADDR_COUNT>(argsTuple);
+
+        FillAddrs(argsTuple, MakeIndexSequence<ADDR_COUNT>{});
+
+        LaunchWithArgs(config, count, std::move(argsTuple), MakeIndexSequence<sizeof...(Args) - ADDR_COUNT - 1>{});
+    }
+
+    // 按 RunParallel 相同的划分，由将来处理各 block 的工作线程对输入输出做首次访问（写零），
+    // 使新分配（尚未触碰）的页落在这些线程所在的 NUMA 节点上；应在写入输入数据之前调用
+    // blockDim 与执行时一样先经 Autotuner::Default() 解析、再由 tiling 函数改写，首次访问与计算的划分保持一致
+    template <typename... Args>
+    void FirstTouch(ThreadPool& pool, std::size_t blockDim, Args&&... args) {
+        static_assert(sizeof...(Args) == ADDR_COUNT + 1, "FirstTouch takes addrs and count only!");
+
+        auto argsTuple = ForwardAsTuple(std::forward<Args>(args)...);
+        std::size_t count = TupleElemGet<ADDR_COUNT>(argsTuple);
+        FillAddrs(argsTuple, MakeIndexSequence<ADDR_COUNT>{});
+
+        LaunchConfig config = Autotuner::Default().Resolve(Signature(), count, LaunchConfig{&pool, blockDim});
+        PrepareTiling(config, count);
+        blockDim = std::max<std::size_t>(config.blockDim, 1);
+        pool.Dispatch(blockDim, [this, count, blockDim](std::size_t blockIdx) {
+            BlockRange range = BlockPartition(count, blockDim, blockIdx);
+            typename TensorTuple<INPUTS>::type inTensors;
+            typename TensorTuple<OUTPUTS>::type outTensors;
+            InitInputTensors(inTensors, count, range);
+            InitOutputTensors(outTensors, count, range);
+
+            auto touch = [](auto& tensor) { std::memset(tensor.data, 0, tensor.size); };
+            TupleForEach(inTensors, touch);
+            TupleForEach(outTensors, touch);
+        });
+    }
+
+    // 不带属性参数的 kernel 走非模板入口，常用组合可在库中预先实例化（见 kernel_ops.h）
+    void Launch(const LaunchConfig& config, std::size_t count);
+
+    template <typename... Attrs>
+    void Launch(const LaunchConfig& config, std::size_t count, Attrs&&... attrs) {
+        Execute(config, count, std::forward<Attrs>(attrs)...);
+    }
+
+private:
+    template <typename ArgsType, std::size_t... Is>
+    void LaunchWithArgs(const LaunchConfig& config, std::size_t count, ArgsType&& args, IndexSequence<Is...>) {
+        Launch(config, count, TupleElemGet<ADDR_COUNT + 1 + Is>(std::forward<ArgsType>(args))...);
+    }
+
+    template <typename... Attrs>
+    void Execute(const LaunchConfig& launchConfig, std::size_t count, Attrs&&... attrs) {
+        ScopedLaunch launch = Profile(RecordKind::LAUNCH, count);
+        LaunchConfig config = Autotuner::Default().Resolve(Signature(), count, launchConfig);
+        const TilingData& tiling = PrepareTiling(config, count);
+        std::size_t blockDim = std::max<std::size_t>(config.blockDim, 1);
+        CheckUbBudget(count, blockDim, config.tileSize);
+        SimLaunch sim(Signature(), count, blockDim, config.tileSize, IN_BYTES, OUT_BYTES, OPS_PER_ELEM);
+
+        if (config.pool == nullptr) {
+            // 没有线程池时在调用线程上依次执行各 block
+            for (std::size_t blockIdx = 0; blockIdx < blockDim; ++blockIdx) {
+                BlockRange range = BlockPartition(count, blockDim, blockIdx);
+                ScopedCounters counters(Signature(), range.count);
+                BlockScope scope(blockIdx, blockDim);
+                ExecuteBlock(op_, count, blockIdx, range, config.tileSize, tiling, sim, attrs...);
+            }
+            return;
+        }
+        if (config.schedule == LaunchSchedule::STATIC) {
+            config.pool->Dispatch(blockDim, [&](std::size_t blockIdx) {
+                BlockRange range = BlockPartition(count, blockDim, blockIdx);
+                ScopedLaunch block = Profile(RecordKind::BLOCK, range.count);
+                ScopedCounters counters(Signature(), range.count);
+                BlockScope scope(blockIdx, blockDim);
+                OP op(op_);
+                ExecuteBlock(op, count, blockIdx, range, config.tileSize, tiling, sim, attrs...);
+            });
+            return;
+        }
+        config.pool->DispatchStealing(blockDim, STEAL_CHUNKS_PER_BLOCK, [&](std::size_t chunkIdx) {
+            std::size_t blockIdx = chunkIdx / STEAL_CHUNKS_PER_BLOCK;
+            BlockRange block = BlockPartition(count, blockDim, blockIdx);
+            BlockRange chunk = BlockPartition(block.count, STEAL_CHUNKS_PER_BLOCK, chunkIdx % STEAL_CHUNKS_PER_BLOCK);
+            if (chunk.count == 0) {
+                return;
+            }
+            ScopedLaunch profiled = Profile(RecordKind::BLOCK, chunk.count);
+            ScopedCounters counters(Signature(), chunk.count);
+            BlockScope scope(blockIdx, blockDim);
+            OP op(op_);
+            ExecuteBlock(op, count, blockIdx, BlockRange{block.offset + chunk.offset, chunk.count}, config.tileSize,
+                         tiling, sim, attrs...);
+        });
+    }
+
+    // 同一 count（及启动配置）只调用一次 tiling 函数，结果连同改写后的 blockDim / tileSize 缓存到下次变化为止
+    const TilingData& PrepareTiling(LaunchConfig& config, std::size_t count) {
+        if (!TILING::ENABLED) {
+            return tiling_;
+        }
+        if (!tilingValid_ || tilingCount_ != count || tilingBlockDim_ != config.blockDim ||
+            tilingTileSize_ != config.tileSize) {
+            TilingContext context{count, config.pool == nullptr ? 1 : config.pool->Size(),
+                                  IN_BYTES, OUT_BYTES, config.blockDim, config.tileSize};
+            tiling_ = TilingData();
+            TILING::Compute(context, tiling_);
+            tilingValid_ = true;
+            tilingCount_ = count;
+            tilingBlockDim_ = config.blockDim;
+            tilingTileSize_ = config.tileSize;
+            tiledBlockDim_ = context.blockDim;
+            tiledTileSize_ = context.tileSize;
+        }
+        config.blockDim = tiledBlockDim_;
+        config.tileSize = tiledTileSize_;
+        return tiling_;
+    }
+
+    // 在派发前检查最大的 tile 的临时 Tensor 能否放入 UB，OP 在 block 内自行分配的 LocalTensor 在分配时检查
+    static void CheckUbBudget(std::size_t count, std::size_t blockDim, std::size_t tileSize) {
+        if (TEMP_COUNT == 0) {
+            return;
+        }
+        std::size_t largest = BlockPartition(count, blockDim, 0).count;
+        std::size_t tile = (tileSize == 0 || tileSize > largest) ? largest : tileSize;
+        std::size_t required = UbTempBytes(tile);
+        if (required > UnifiedBuffer::Capacity()) {
+            throw UbOverflowError(DemangleName(Signature()) + ": temp tensors of a " + std::to_string(tile) +
+                                  "-element tile need " + std::to_string(required) + " bytes, unified buffer has " +
+                                  std::to_string(UnifiedBuffer::Capacity()));
+        }
+    }
+
+    static ScopedLaunch Profile(RecordKind kind, std::size_t count) {
+        return ScopedLaunch(Signature(), kind, count, IN_BYTES * count, OUT_BYTES * count);
+    }
+
+    // block 内按 tileSize 个元素一段依次调用 OP，每个 tile 结束时释放其在 UB 上的分配
+    // Simulator 开启时逐 tile 记录 DataCopy 字节数与向量运算数
+    template <typename... Attrs>
+    void ExecuteBlock(OP& op, std::size_t count, std::size_t blockIdx, const BlockRange& range, std::size_t tileSize,
+                      const TilingData& tiling, SimLaunch& sim, Attrs&&... attrs) {
+        std::size_t tile = (tileSize == 0 || tileSize > range.count) ? range.count : tileSize;
+        std::size_t offset = 0;
+        do {
+            BlockRange tileRange{range.offset + offset, std::min(tile, range.count - offset)};
+            UbScope ub;
+            SimTile simTile(sim, blockIdx, tileRange.count);
+
+            typename TensorTuple<INPUTS>::type inTensors;
+            typename TensorTuple<OUTPUTS>::type outTensors;
+            typename TensorTuple<TEMPS>::type tempTensors;
+
+            InitInputTensors(inTensors, count, tileRange);
+            InitOutputTensors(outTensors, count, tileRange);
+            InitTempTensors(tempTensors, tileRange);
+
+            Compute(op, inTensors, outTensors, tempTensors,
+                    MakeIndexSequence<INPUT_COUNT>{},
+                    MakeIndexSequence<OUTPUT_COUNT>{},
+                    MakeIndexSequence<TEMP_COUNT>{},
+                    tileRange.count, tiling, attrs...);
+            offset += tile;
+        } while (offset < range.count);
+    }
+
+    template <typename TUPLE>
+    void InitInputTensors(TUPLE& tuple, std::size_t cnt, const BlockRange& range) {
+        // 初始化每个 Tensor
+        TupleForEach(tuple, [this, cnt, &range](auto& tensor, std::size_t index) { InitInputTensor(tensor, cnt, range, index); });
+    }
+
+    template <typename TUPLE>
+    void InitOutputTensors(TUPLE& tuple, std::size_t cnt, const BlockRange& range) {
+        TupleForEach(tuple, [this, cnt, &range](auto& tensor, std::size_t index) { InitOutputTensor(tensor, cnt, range, index); });
+    }
+
+    template <typename TUPLE>
+    void InitTempTensors(TUPLE& tuple, const BlockRange& range) {
+        TupleForEach(tuple, [this, &range](auto& tensor, std::size_t) { InitTempTensor(tensor, range); });
+    }
+
+    // 第 index 个 Tensor 起始于 addr + offset * cnt，block 再从其中的第 range.offset 个元素开始
+    template <typename T>
+    Tensor<T>& InitInputTensor(Tensor<T>& tensor, std::size_t cnt, const BlockRange& range, std::size_t index) {
+        tensor.data = reinterpret_cast<T*>(inAddrs_[index] + IN_OFFSETS[index] * cnt) + range.offset;
+        tensor.size = sizeof(T) * range.count;
+        return tensor;
+    }
+
+    template <typename T>
+    Tensor<T>& InitOutputTensor(Tensor<T>& tensor, std::size_t cnt, const BlockRange& range, std::size_t index) {
+        tensor.data = reinterpret_cast<T*>(outAddrs_[index] + OUT_OFFSETS[index] * cnt) + range.offset;
+        tensor.size = sizeof(T) * range.count;
+        return tensor;
+    }
+
+    // 临时 Tensor 在当前 block 的 UB 中分配，与 GM 地址无关
+    template <typename T>
+    Tensor<T>& InitTempTensor(Tensor<T>& tensor, const BlockRange& range) {
+        tensor.data = AllocLocal<T>(range.count).data;
+        tensor.size = sizeof(T) * range.count;
+        return tensor;
+    }
+
+    template<typename IN_TUPLE, typename OUT_TUPLE, typename TMP_TUPLE,
+            std::size_t... I1, std::size_t... I2,  std::size_t... I3, typename... Attrs>
+    void Compute(OP& op, IN_TUPLE& inTensors, OUT_TUPLE& outTensors, TMP_TUPLE& tempTensors,
+                 IndexSequence<I1...>, IndexSequence<I2...>, IndexSequence<I3...>,
+                 std::size_t cnt, const TilingData& tiling, Attrs&&... attrs) {
+        if constexpr (TILING::ENABLED) {
+            op(TupleElemGet<I1>(inTensors)...,
+                TupleElemGet<I2>(outTensors)...,
+                TupleElemGet<I3>(tempTensors)...,
+                cnt,
+                tiling,
+                std::forward<Attrs>(attrs)...);
+        } else {
+            op(TupleElemGet<I1>(inTensors)...,
+                TupleElemGet<I2>(outTensors)...,
+                TupleElemGet<I3>(tempTensors)...,
+                cnt,
+                std::forward<Attrs>(attrs)...);
+        }
+    }
+
+private:
+    template <typename TupleType, std::size_t... Is>
+    void FillAddrs(TupleType& tuple, IndexSequence<Is...>) {
+        Addr argsArr[ADDR_COUNT] = { TupleElemGet<Is>(tuple)... };
+        for (std::size_t i = 0; i < INPUT_COUNT; ++i) {
+            inAddrs_[i] = argsArr[i];
+        }
+        for (std::size_t i = 0; i < OUTPUT_COUNT; ++i) {
+            outAddrs_[i] = argsArr[INPUT_COUNT + i];
+        }
+    }
+
+private:
+    OP op_;
+
+    TilingData tiling_{};
+    bool tilingValid_{false};
+    std::size_t tilingCount_{0};
+    std::size_t tilingBlockDim_{0};
+    std::size_t tilingTileSize_{0};
+    std::size_t tiledBlockDim_{1};
+    std::size_t tiledTileSize_{0};
+
+    Addr inAddrs_[INPUT_COUNT];
+    Addr outAddrs_[OUTPUT_COUNT];
+};
+
+// 类外定义（非 inline），使 extern template 声明能够阻止使用方重复实例化
+template <typename OP, typename INPUT_TYPES, typename OUTPUT_TYPES, typename TEMP_TYPES>
+void ElemWise<OP, INPUT_TYPES, OUTPUT_TYPES, TEMP_TYPES>::Launch(const LaunchConfig& config, std::size_t count) {
+    Execute(config, count);
+}
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef HUGE_PAGE_H
+#define HUGE_PAGE_H
+
+#include <cstddef>
+#include "kernel.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(2) << 20;
+
+// 大页申请策略
+enum class HugePagePolicy {
+    AUTO,           // 依次尝试显式大页、透明大页，最后退化为普通页
+    EXPLICIT,       // 仅使用 hugetlbfs 预留的显式大页（MAP_HUGETLB），失败则抛出异常
+    TRANSPARENT,    // 2 MiB 对齐的匿名映射并 madvise(MADV_HUGEPAGE)
+};
+
+// 实际得到的页类型
+enum class HugePageMode {
+    EXPLICIT,
+    TRANSPARENT,
+    NORMAL,
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// HugePageBuffer：面向大 Tensor 的 2 MiB 大页内存
+// 映射时不预先触碰任何页，物理页在首次访问时才分配在访问线程所在的 NUMA 节点上，
+// 因此应先用 ElemWise::FirstTouch 由各 block 的工作线程完成首次访问，再写入数据
+class HugePageBuffer {
+public:
+    explicit HugePageBuffer(std::size_t bytes, HugePagePolicy policy = HugePagePolicy::AUTO);
+    ~HugePageBuffer();
+
+    HugePageBuffer(const HugePageBuffer&) = delete;
+    HugePageBuffer& operator=(const HugePageBuffer&) = delete;
+
+    HugePageBuffer(HugePageBuffer&& other) noexcept;
+    HugePageBuffer& operator=(HugePageBuffer&& other) noexcept;
+
+    Addr Data() const {
+        return addr_;
+    }
+
+    // 可用字节数，按 HUGE_PAGE_SIZE 向上取整
+    std::size_t Size() const {
+        return bytes_;
+    }
+
+    HugePageMode Mode() const {
+        return mode_;
+    }
+
+private:
+    void Release();
+
+private:
+    Addr addr_{nullptr};
+    std::size_t bytes_{0};
+    HugePageMode mode_{HugePageMode::NORMAL};
+};
+
+}
+
+#endif
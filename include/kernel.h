@@ -0,0 +1,136 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <cstddef>
+#include <type_traits>
+#include "type_list.h"
+#include "tuple.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// kernel 入参地址：同一类参数（输入或输出）按 SoA 方式打包在一块内存中，
+// 第 i 个 Tensor 起始于 addr_i + TypeList_ByteOffset<List, i> * count
+using Addr = unsigned char*;
+
+template<typename T>
+struct Tensor {
+    T* data;
+    std::size_t size;
+};
+
+template <typename T>
+struct TypeToTensor {
+    using type = Tensor<T>;
+};
+
+template <typename List>
+struct TensorTuple {
+private:
+    using Tensors = typename TypeList_Map<List, TypeToTensor>::type;
+public:
+    using type = typename TupleFromTypeList<Tensors>::type;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+enum class ParamType {
+    INPUT,
+    OUTPUT,
+    TEMP,
+};
+
+template<ParamType PT, typename ... Ts>
+struct ParamTypes{
+    using types = TypeList<Ts...>;
+    static constexpr ParamType usage = PT;
+};
+
+template<typename ... Ts>
+using Input = ParamTypes<ParamType::INPUT, Ts...>;
+
+template<typename ... Ts>
+using Output = ParamTypes<ParamType::OUTPUT, Ts...>;
+
+template<typename ... Ts>
+using Temp = ParamTypes<ParamType::TEMP, Ts...>;
+
+// 每个元素的浮点运算次数，用于 roofline 分析
+// OP 可以在类内声明 static constexpr double FLOPS_PER_ELEM，也可以特化 KernelFlops；未声明时视为 0
+template <typename OP, typename = void>
+struct KernelFlops {
+    static constexpr double value = 0.0;
+};
+
+template <typename OP>
+struct KernelFlops<OP, std::void_t<decltype(OP::FLOPS_PER_ELEM)>> {
+    static constexpr double value = OP::FLOPS_PER_ELEM;
+};
+
+// 参数中是否有浮点类型；全为整数的 kernel 不计浮点运算
+template <typename List>
+struct HasFloatingPoint;
+
+template <typename... Ts>
+struct HasFloatingPoint<TypeList<Ts...>> {
+    static constexpr bool value = (std::is_floating_point<Ts>::value || ...);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+class ThreadPool;
+
+// block 的调度方式
+enum class LaunchSchedule {
+    STATIC,     // 第 b 个 block 固定由 pool 的第 b % Size() 个线程执行
+    STEALING,   // 初始分配与 STATIC 相同，每个 block 再细分为 STEAL_CHUNKS_PER_BLOCK 个 chunk 供空闲线程窃取
+};
+
+constexpr std::size_t STEAL_CHUNKS_PER_BLOCK = 8;
+
+// blockDim 取 AUTO_BLOCK_DIM 时由 Autotuner 按 kernel 签名与 count 档位选择 blockDim 与 tileSize
+constexpr std::size_t AUTO_BLOCK_DIM = 0;
+
+// kernel 的启动配置：pool 为空时在调用线程上单 block 执行，否则把 count 划分为 blockDim 个 block 按 schedule 调度
+// 每个 block 内再按 tileSize 个元素一段多次调用 OP，tileSize 为 0 时整个 block 一次调用
+struct LaunchConfig {
+    ThreadPool* pool{nullptr};
+    std::size_t blockDim{1};
+    LaunchSchedule schedule{LaunchSchedule::STATIC};
+    std::size_t tileSize{0};
+};
+
+// 单个 block 负责的元素区间 [offset, offset + count)
+struct BlockRange {
+    std::size_t offset;
+    std::size_t count;
+};
+
+// block 起点按 BLOCK_ALIGN 个元素对齐，使任意类型的 block 边界都落在 64 字节上，避免伪共享
+constexpr std::size_t BLOCK_ALIGN = 64;
+
+inline BlockRange BlockPartition(std::size_t total, std::size_t blockDim, std::size_t blockIdx,
+                                 std::size_t align = BLOCK_ALIGN) {
+    std::size_t chunks = (total + align - 1) / align;
+    std::size_t base = chunks / blockDim;
+    std::size_t extra = chunks % blockDim;
+    std::size_t begin = (blockIdx * base + (blockIdx < extra ? blockIdx : extra)) * align;
+    std::size_t end = begin + (base + (blockIdx < extra ? 1 : 0)) * align;
+    begin = begin < total ? begin : total;
+    end = end < total ? end : total;
+    return BlockRange{begin, end - begin};
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+enum class KernelType {
+    ELEM_WISE,
+    REDUCE,
+    MATMUL,     // 对应设备上 Cube 单元执行的矩阵乘（见 matmul.h）
+    CONV,       // 以隐式 GEMM 在 Cube 单元上执行的卷积（见 conv.h）
+};
+
+}
+
+#endif
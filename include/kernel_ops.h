@@ -0,0 +1,64 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef KERNEL_OPS_H
+#define KERNEL_OPS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "elem_wise.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 常用二元逐元素 OP：z = x op y
+#define ASL_DEFINE_BINARY_OP(NAME, EXPR)                                              \
+struct NAME {                                                                         \
+    static constexpr double FLOPS_PER_ELEM = 1.0;                                     \
+                                                                                      \
+    template <typename T>                                                             \
+    void operator()(Tensor<T> x, Tensor<T> y, Tensor<T> z, std::size_t cnt) const {   \
+        const T* __restrict__ xs = x.data;                                            \
+        const T* __restrict__ ys = y.data;                                            \
+        T* __restrict__ zs = z.data;                                                  \
+        for (std::size_t i = 0; i < cnt; ++i) {                                       \
+            const T a = xs[i];                                                        \
+            const T b = ys[i];                                                        \
+            zs[i] = (EXPR);                                                           \
+        }                                                                             \
+    }                                                                                 \
+};
+
+ASL_DEFINE_BINARY_OP(OpAdd, a + b)
+ASL_DEFINE_BINARY_OP(OpSub, a - b)
+ASL_DEFINE_BINARY_OP(OpMul, a * b)
+ASL_DEFINE_BINARY_OP(OpDiv, a / b)
+ASL_DEFINE_BINARY_OP(OpMax, a < b ? b : a)
+ASL_DEFINE_BINARY_OP(OpMin, b < a ? b : a)
+
+#undef ASL_DEFINE_BINARY_OP
+
+template <typename OP, typename T>
+using BinaryElemWise = ElemWise<OP, Input<T, T>, Output<T>>;
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 库中预先实例化的 dtype x OP 组合，使用方只链接不再重复实例化
+#define ASL_FOR_EACH_BINARY_OP(X, T) \
+    X(OpAdd, T) X(OpSub, T) X(OpMul, T) X(OpDiv, T) X(OpMax, T) X(OpMin, T)
+
+#define ASL_FOR_EACH_PREBUILT_ELEM_WISE(X) \
+    ASL_FOR_EACH_BINARY_OP(X, float)       \
+    ASL_FOR_EACH_BINARY_OP(X, double)      \
+    ASL_FOR_EACH_BINARY_OP(X, int32_t)     \
+    ASL_FOR_EACH_BINARY_OP(X, int64_t)
+
+#define ASL_DECLARE_PREBUILT_ELEM_WISE(OP, T) extern template class ElemWise<OP, Input<T, T>, Output<T>>;
+
+ASL_FOR_EACH_PREBUILT_ELEM_WISE(ASL_DECLARE_PREBUILT_ELEM_WISE)
+
+#undef ASL_DECLARE_PREBUILT_ELEM_WISE
+
+}
+
+#endif
@@ -0,0 +1,335 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef MATMUL_H
+#define MATMUL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+#include "autotuner.h"
+#include "kernel.h"
+#include "profiler.h"
+#include "simulator.h"
+#include "thread_pool.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// C(m x n) = A(m x k) * B(k x n) + beta * C，三个矩阵均为行优先连续存放
+// transA / transB 为真时 A、B 按转置存放（A 为 k x m，B 为 n x k）
+struct MatmulShape {
+    std::size_t m;
+    std::size_t n;
+    std::size_t k;
+    bool transA{false};
+    bool transB{false};
+};
+
+// 三级分块：kc x nc 的 B 面板常驻 L3 / L2，mc x kc 的 A 面板常驻 L2，微内核的 mr x nr 结果常驻寄存器
+// mc、nc 会按微内核的 mr、nr 向上取整
+struct MatmulBlocking {
+    std::size_t mc{96};
+    std::size_t kc{256};
+    std::size_t nc{2048};
+};
+
+// 寄存器分块的微内核：C[mr x nr] += packedA[kc x mr] * packedB[kc x nr]，C 的行间隔为 ldc
+// mr x nr 不超过 GEMM_MAX_KERNEL_ELEMS（最大的是 AVX-512 的 8 x 32），边缘子块的临时缓冲区按此分配在栈上
+constexpr std::size_t GEMM_MAX_KERNEL_ELEMS = 8 * 32;
+
+template <typename T>
+struct GemmMicroKernel {
+    using Func = void (*)(std::size_t kc, const T* packedA, const T* packedB, T* c, std::size_t ldc);
+
+    std::size_t mr;
+    std::size_t nr;
+    Func run;
+};
+
+// 通用的标量微内核，供 float 以外的类型使用
+template <typename T, std::size_t MR, std::size_t NR>
+void GenericGemmKernel(std::size_t kc, const T* packedA, const T* packedB, T* c, std::size_t ldc) {
+    static_assert(MR * NR <= GEMM_MAX_KERNEL_ELEMS, "micro-kernel tile exceeds GEMM_MAX_KERNEL_ELEMS");
+    T acc[MR][NR] = {};
+    for (std::size_t p = 0; p < kc; ++p) {
+        for (std::size_t i = 0; i < MR; ++i) {
+            const T a = packedA[p * MR + i];
+            for (std::size_t j = 0; j < NR; ++j) {
+                acc[i][j] += a * packedB[p * NR + j];
+            }
+        }
+    }
+    for (std::size_t i = 0; i < MR; ++i) {
+        for (std::size_t j = 0; j < NR; ++j) {
+            c[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+// float 按 VectorIsa() 选择 AVX-512（8 x 32）、AVX2（6 x 16）或标量微内核
+GemmMicroKernel<float> SelectGemmKernelF32();
+
+template <typename T>
+GemmMicroKernel<T> SelectGemmKernel() {
+    if constexpr (std::is_same<T, float>::value) {
+        return SelectGemmKernelF32();
+    } else {
+        return GemmMicroKernel<T>{4, 8, &GenericGemmKernel<T, 4, 8>};
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// BlockedGemm：Goto / BLIS 式的分块打包 GEMM 驱动，操作数由 SOURCE 提供
+// SOURCE 描述 Batch() 组互相独立的 C(M x N) = A(M x K) * B(K x N)，需要提供：
+//   Batch()、M()、N()、K()、Ldc()、T* C(batch)
+//   PackA(packed, mr, batch, ic, mc, pc, kc)：把 A[ic : ic + mc, pc : pc + kc] 打包为 ceil(mc / mr) 个 kc x mr 的面板
+//   PackB(packed, nr, batch, pc, kc, jc, nc)：把 B[pc : pc + kc, jc : jc + nc] 打包为 ceil(nc / nr) 个 kc x nr 的面板
+//   不足 mr 行 / nr 列的部分补零；Matmul 的操作数是连续矩阵，Conv2d 的是在打包时即时展开的 im2col（见 conv.h）
+// 每组 C 按 mc x ncTile 划分为宏块，宏块按 LaunchConfig 派发给各 block：STATIC 时第 b 个 block 依次执行
+// 第 b、b + blockDim、... 个宏块；STEALING 时与 LaunchRows 相同，第 b 个 block 持有从 b * chunks 起的连续
+// chunks = ceil(宏块数 / blockDim) 个宏块，所属线程把区间不断二分，其余部分可被空闲线程窃取
+// 每个宏块内沿 K 以 kc 为步长打包 B、A，再由微内核逐个计算 mr x nr 的子块
+// 启动配置先以 Batch() * M() * N() 个输出元素经 Autotuner::Default().Resolve 解析；LaunchConfig::tileSize 非 0 时
+// 为宏块列数 ncTile 的上限（按 nr 向上取整）。GEMM 不经过 UB，每个宏块按 A、B 面板与 C 的字节数及乘加次数记录 SimTile
+template <typename T, typename SOURCE>
+class BlockedGemm {
+public:
+    // C = A * B + beta * C；blockDim 为 AUTO_BLOCK_DIM 时取调优结果，未调优时取 pool.Size()
+    static void Run(const LaunchConfig& launchConfig, const MatmulBlocking& blocking, const SOURCE& source, T beta,
+                    const char* signature) {
+        std::size_t count = source.Batch() * source.M() * source.N();
+        LaunchConfig config = Autotuner::Default().Resolve(signature, count, launchConfig);
+        Plan plan = MakePlan(config, blocking, source);
+        std::size_t blockDim = std::max<std::size_t>(std::min(plan.blockDim, plan.tiles), 1);
+        SimLaunch sim(signature, count, blockDim, plan.mc * plan.ncTile, 0, 0, 0.0);
+        auto runTile = [&](std::size_t blockIdx, std::size_t tile) {
+            ScopedLaunch block(signature, RecordKind::BLOCK, 0, 0, 0);
+            ComputeTile(plan, source, beta, tile, sim, blockIdx);
+        };
+        if (config.pool == nullptr || plan.tiles <= 1) {
+            for (std::size_t tile = 0; tile < plan.tiles; ++tile) {
+                ComputeTile(plan, source, beta, tile, sim, 0);
+            }
+            return;
+        }
+        if (config.schedule == LaunchSchedule::STEALING) {
+            std::size_t chunks = (plan.tiles + blockDim - 1) / blockDim;
+            config.pool->DispatchStealing(blockDim, chunks, [&](std::size_t tile) {
+                if (tile < plan.tiles) {
+                    runTile(tile / chunks, tile);
+                }
+            });
+            return;
+        }
+        config.pool->Dispatch(blockDim, [&](std::size_t blockIdx) {
+            for (std::size_t tile = blockIdx; tile < plan.tiles; tile += blockDim) {
+                runTile(blockIdx, tile);
+            }
+        });
+    }
+
+    static std::size_t RoundUp(std::size_t value, std::size_t unit) {
+        return (std::max<std::size_t>(value, 1) + unit - 1) / unit * unit;
+    }
+
+private:
+    struct Plan {
+        GemmMicroKernel<T> kernel;
+        std::size_t mc;
+        std::size_t kc;
+        std::size_t ncTile;     // 宏块的列数，不超过 nc
+        std::size_t tilesM;
+        std::size_t tilesPerBatch;
+        std::size_t tiles;
+        std::size_t blockDim;
+    };
+
+    static Plan MakePlan(const LaunchConfig& config, const MatmulBlocking& blocking, const SOURCE& source) {
+        Plan plan;
+        plan.kernel = SelectGemmKernel<T>();
+        if (plan.kernel.mr * plan.kernel.nr > GEMM_MAX_KERNEL_ELEMS) {
+            throw std::logic_error("BlockedGemm: micro-kernel tile exceeds GEMM_MAX_KERNEL_ELEMS");
+        }
+        plan.mc = RoundUp(blocking.mc, plan.kernel.mr);
+        plan.kc = std::max<std::size_t>(blocking.kc, 1);
+        plan.ncTile = std::min(RoundUp(blocking.nc, plan.kernel.nr), RoundUp(source.N(), plan.kernel.nr));
+        if (config.tileSize != 0) {
+            plan.ncTile = std::min(plan.ncTile, RoundUp(config.tileSize, plan.kernel.nr));
+        }
+        plan.blockDim = config.pool == nullptr ? 1
+                      : (config.blockDim == AUTO_BLOCK_DIM ? config.pool->Size() : config.blockDim);
+        plan.tilesM = (source.M() + plan.mc - 1) / plan.mc;
+
+        // 宏块数不足 block 数的 2 倍时把列宽减半（保持 nr 的整数倍），使各线程都有宏块可做
+        auto tileCount = [&]() { return source.Batch() * plan.tilesM * ((source.N() + plan.ncTile - 1) / plan.ncTile); };
+        while (plan.blockDim > 1 && tileCount() < 2 * plan.blockDim && plan.ncTile > plan.kernel.nr) {
+            plan.ncTile = RoundUp(plan.ncTile / 2, plan.kernel.nr);
+        }
+        plan.tiles = (source.M() == 0 || source.N() == 0) ? 0 : tileCount();
+        plan.tilesPerBatch = plan.tiles / std::max<std::size_t>(source.Batch(), 1);
+        return plan;
+    }
+
+    static void ComputeTile(const Plan& plan, const SOURCE& source, T beta, std::size_t tile, SimLaunch& sim,
+                            std::size_t blockIdx) {
+        const std::size_t mr = plan.kernel.mr;
+        const std::size_t nr = plan.kernel.nr;
+        const std::size_t ldc = source.Ldc();
+        std::size_t batch = tile / plan.tilesPerBatch;
+        tile %= plan.tilesPerBatch;
+        std::size_t ic = (tile % plan.tilesM) * plan.mc;
+        std::size_t jc = (tile / plan.tilesM) * plan.ncTile;
+        std::size_t mc = std::min(plan.mc, source.M() - ic);
+        std::size_t nc = std::min(plan.ncTile, source.N() - jc);
+        T* c = source.C(batch);
+
+        for (std::size_t i = 0; i < mc; ++i) {
+            T* row = c + (ic + i) * ldc + jc;
+            for (std::size_t j = 0; j < nc; ++j) {
+                row[j] = beta == T(0) ? T(0) : beta * row[j];
+            }
+        }
+
+        // 打包缓冲区按线程复用，大小只与分块有关
+        thread_local std::vector<T> packedA;
+        thread_local std::vector<T> packedB;
+        packedA.resize(RoundUp(mc, mr) * plan.kc);
+        packedB.resize(RoundUp(nc, nr) * plan.kc);
+
+        T edge[GEMM_MAX_KERNEL_ELEMS];
+        for (std::size_t pc = 0; pc < source.K(); pc += plan.kc) {
+            std::size_t kc = std::min(plan.kc, source.K() - pc);
+            source.PackB(packedB.data(), nr, batch, pc, kc, jc, nc);
+            source.PackA(packedA.data(), mr, batch, ic, mc, pc, kc);
+
+            for (std::size_t jr = 0; jr < nc; jr += nr) {
+                std::size_t cols = std::min(nr, nc - jr);
+                for (std::size_t ir = 0; ir < mc; ir += mr) {
+                    std::size_t rows = std::min(mr, mc - ir);
+                    const T* panelA = packedA.data() + ir * kc;
+                    const T* panelB = packedB.data() + jr * kc;
+                    T* sub = c + (ic + ir) * ldc + jc + jr;
+                    if (rows == mr && cols == nr) {
+                        plan.kernel.run(kc, panelA, panelB, sub, ldc);
+                        continue;
+                    }
+                    // 边缘子块先算到临时缓冲区，再累加有效部分
+                    std::fill_n(edge, mr * nr, T(0));
+                    plan.kernel.run(kc, panelA, panelB, edge, nr);
+                    for (std::size_t i = 0; i < rows; ++i) {
+                        for (std::size_t j = 0; j < cols; ++j) {
+                            sub[i * ldc + j] += edge[i * nr + j];
+                        }
+                    }
+                }
+            }
+        }
+
+        if (sim.Active()) {
+            std::size_t bytesIn = ((mc + nc) * source.K() + (beta == T(0) ? 0 : mc * nc)) * sizeof(T);
+            sim.RecordTile(blockIdx, mc * nc, TileCost{bytesIn, mc * nc * sizeof(T), mc * nc * source.K()});
+        }
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 连续存放的 A(m x k)、B(k x n) 作为 BlockedGemm 的操作数，按 transA / transB 取元素
+template <typename T>
+struct DenseGemmSource {
+    const T* a;
+    const T* b;
+    T* c;
+    MatmulShape shape;
+
+    std::size_t Batch() const { return 1; }
+    std::size_t M() const { return shape.m; }
+    std::size_t N() const { return shape.n; }
+    std::size_t K() const { return shape.k; }
+    std::size_t Ldc() const { return shape.n; }
+    T* C(std::size_t) const { return c; }
+
+    T ElemA(std::size_t i, std::size_t p) const {
+        return shape.transA ? a[p * shape.m + i] : a[i * shape.k + p];
+    }
+
+    T ElemB(std::size_t p, std::size_t j) const {
+        return shape.transB ? b[j * shape.k + p] : b[p * shape.n + j];
+    }
+
+    void PackA(T* packed, std::size_t mr, std::size_t, std::size_t ic, std::size_t mc,
+               std::size_t pc, std::size_t kc) const {
+        for (std::size_t ir = 0; ir < mc; ir += mr) {
+            std::size_t rows = std::min(mr, mc - ir);
+            for (std::size_t p = 0; p < kc; ++p) {
+                for (std::size_t i = 0; i < mr; ++i) {
+                    *packed++ = i < rows ? ElemA(ic + ir + i, pc + p) : T(0);
+                }
+            }
+        }
+    }
+
+    void PackB(T* packed, std::size_t nr, std::size_t, std::size_t pc, std::size_t kc,
+               std::size_t jc, std::size_t nc) const {
+        for (std::size_t jr = 0; jr < nc; jr += nr) {
+            std::size_t cols = std::min(nr, nc - jr);
+            for (std::size_t p = 0; p < kc; ++p) {
+                if (!shape.transB && cols == nr) {
+                    std::copy_n(b + (pc + p) * shape.n + jc + jr, nr, packed);
+                    packed += nr;
+                    continue;
+                }
+                for (std::size_t j = 0; j < nr; ++j) {
+                    *packed++ = j < cols ? ElemB(pc + p, jc + jr + j) : T(0);
+                }
+            }
+        }
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Matmul：KernelType::MATMUL 的执行器，C(m x n) = A(m x k) * B(k x n) + beta * C
+template <typename T>
+class Matmul {
+public:
+    static constexpr KernelType TYPE = KernelType::MATMUL;
+
+    explicit Matmul(const MatmulBlocking& blocking = MatmulBlocking()) : blocking_(blocking) {}
+
+    static const char* Signature() {
+        return typeid(Matmul).name();
+    }
+
+    void Run(Addr a, Addr b, Addr c, const MatmulShape& shape, T beta = T(0)) {
+        RunWithConfig(LaunchConfig{}, a, b, c, shape, beta);
+    }
+
+    // blockDim 为 AUTO_BLOCK_DIM 时取 Autotuner::Default() 中以 m * n 查到的调优结果，未调优时取 pool.Size()
+    void RunParallel(ThreadPool& pool, std::size_t blockDim, Addr a, Addr b, Addr c, const MatmulShape& shape,
+                     T beta = T(0)) {
+        RunWithConfig(LaunchConfig{&pool, blockDim}, a, b, c, shape, beta);
+    }
+
+    void RunWithConfig(const LaunchConfig& config, Addr a, Addr b, Addr c, const MatmulShape& shape, T beta = T(0)) {
+        std::size_t bytesRead = (shape.m * shape.k + shape.k * shape.n + (beta == T(0) ? 0 : shape.m * shape.n)) * sizeof(T);
+        ScopedLaunch launch(Signature(), RecordKind::LAUNCH, shape.m * shape.n, bytesRead, shape.m * shape.n * sizeof(T));
+
+        DenseGemmSource<T> source{reinterpret_cast<const T*>(a), reinterpret_cast<const T*>(b), reinterpret_cast<T*>(c), shape};
+        BlockedGemm<T, DenseGemmSource<T>>::Run(config, blocking_, source, beta, Signature());
+    }
+
+    const MatmulBlocking& Blocking() const {
+        return blocking_;
+    }
+
+private:
+    MatmulBlocking blocking_;
+};
+
+}
+
+#endif
@@ -0,0 +1,236 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef NORMALIZATION_H
+#define NORMALIZATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <typeinfo>
+#include "autotuner.h"
+#include "kernel.h"
+#include "profiler.h"
+#include "row_launch.h"
+#include "simulator.h"
+#include "unified_buffer.h"
+#include "vector_ops.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 行方向的融合归一化：x、y 为行优先的 rows x cols 矩阵，每行独立归一化
+// 每行按 tile 搬入 UB 两次：第一遍流式累计统计量（在线 max / sum、Welford 均值 / 方差），
+// 第二遍归一化并搬出，中间结果只存在于 tile 大小的 UB 缓冲中，GM 流量为读 2 遍、写 1 遍
+// LaunchConfig::tileSize 为行内 tile 的元素数，为 0 时取 NORM_TILE_BYTES，且不超过 cols
+constexpr std::size_t NORM_TILE_BYTES = 16 * 1024;
+
+namespace detail {
+    template <typename T>
+    std::size_t NormTileElems(std::size_t cols, std::size_t tileSize) {
+        std::size_t tile = tileSize == 0 ? NORM_TILE_BYTES / sizeof(T) : tileSize;
+        return std::max<std::size_t>(std::min(tile, cols), 1);
+    }
+
+    template <typename T>
+    Tensor<T> RowTensor(Addr addr, std::size_t row, std::size_t offset, std::size_t cols) {
+        return Tensor<T>{reinterpret_cast<T*>(addr) + row * cols + offset, (cols - offset) * sizeof(T)};
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Softmax：y[r] = exp(x[r] - max(x[r])) / sum(exp(x[r] - max(x[r])))
+// 第一遍以在线算法累计：遇到更大的 max 时把已累计的 sum 乘以 exp(旧 max - 新 max)
+// 只用于浮点类型：整数类型没有 -inf 初值，1 / sum 也会截断
+template <typename T>
+class Softmax {
+    static_assert(std::is_floating_point<T>::value, "Softmax requires a floating point type");
+
+public:
+    static constexpr KernelType TYPE = KernelType::REDUCE;
+
+    static const char* Signature() {
+        return typeid(Softmax).name();
+    }
+
+    void Run(Addr x, Addr y, std::size_t rows, std::size_t cols) {
+        RunWithConfig(LaunchConfig{}, x, y, rows, cols);
+    }
+
+    // blockDim 为 AUTO_BLOCK_DIM 时取 Autotuner::Default() 中以 rows * cols 查到的调优结果，未调优时取 pool.Size()
+    void RunParallel(ThreadPool& pool, std::size_t blockDim, Addr x, Addr y, std::size_t rows, std::size_t cols) {
+        RunWithConfig(LaunchConfig{&pool, blockDim}, x, y, rows, cols);
+    }
+
+    void RunWithConfig(const LaunchConfig& config, Addr x, Addr y, std::size_t rows, std::size_t cols) {
+        std::size_t count = rows * cols;
+        ScopedLaunch launch(Signature(), RecordKind::LAUNCH, count, 2 * count * sizeof(T), count * sizeof(T));
+        if (count == 0) {
+            return;
+        }
+        LaunchConfig resolved = Autotuner::Default().Resolve(Signature(), count, config);
+        std::size_t blockDim = RowBlockDim(resolved, rows);
+        std::size_t tile = detail::NormTileElems<T>(cols, resolved.tileSize);
+        SimLaunch sim(Signature(), count, blockDim, tile, 2 * sizeof(T), sizeof(T), 0.0);
+
+        LaunchRows(resolved, rows, blockDim, [&](std::size_t blockIdx, BlockRange range) {
+            UbScope ub;
+            LocalTensor<T> in = AllocLocal<T>(tile);
+            LocalTensor<T> work = AllocLocal<T>(tile);
+            LocalTensor<T> scalar = AllocLocal<T>(1);
+            for (std::size_t row = range.offset; row < range.offset + range.count; ++row) {
+                SimTile simTile(sim, blockIdx, cols);
+                ComputeRow(x, y, row, cols, tile, in, work, scalar);
+            }
+        });
+    }
+
+private:
+    static void ComputeRow(Addr x, Addr y, std::size_t row, std::size_t cols, std::size_t tile,
+                           const LocalTensor<T>& in, const LocalTensor<T>& work, const LocalTensor<T>& scalar) {
+        T max = -std::numeric_limits<T>::infinity();
+        T sum = T(0);
+        for (std::size_t offset = 0; offset < cols; offset += tile) {
+            std::size_t len = std::min(tile, cols - offset);
+            DataCopy(in, detail::RowTensor<T>(x, row, offset, cols), len);
+            ReduceMax(scalar, in, work, len);
+            T newMax = std::max(max, scalar[0]);
+            if (newMax != max) {
+                sum *= std::exp(max - newMax);
+                max = newMax;
+            }
+            Adds(work, in, T(-max), len);
+            Exp(work, work, len);
+            ReduceSum(scalar, work, work, len);
+            sum += scalar[0];
+        }
+
+        T inv = T(1) / sum;
+        for (std::size_t offset = 0; offset < cols; offset += tile) {
+            std::size_t len = std::min(tile, cols - offset);
+            DataCopy(in, detail::RowTensor<T>(x, row, offset, cols), len);
+            Adds(in, in, T(-max), len);
+            Exp(in, in, len);
+            Muls(in, in, inv, len);
+            DataCopy(detail::RowTensor<T>(y, row, offset, cols), in, len);
+        }
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// LayerNorm：y[r] = (x[r] - mean) / sqrt(var + epsilon) * gamma + beta，var 为总体方差
+// gamma、beta 为长度 cols 的向量，传空地址时分别视为全 1、全 0
+// 第一遍对每个 tile 求均值与离差平方和，再按 Chan 的并行 Welford 公式合并到整行，避免 E[x^2] - E[x]^2 的相消误差
+// 只用于浮点类型
+template <typename T>
+class LayerNorm {
+    static_assert(std::is_floating_point<T>::value, "LayerNorm requires a floating point type");
+
+public:
+    static constexpr KernelType TYPE = KernelType::REDUCE;
+
+    explicit LayerNorm(T epsilon = T(1e-5)) : epsilon_(epsilon) {}
+
+    static const char* Signature() {
+        return typeid(LayerNorm).name();
+    }
+
+    void Run(Addr x, Addr gamma, Addr beta, Addr y, std::size_t rows, std::size_t cols) {
+        RunWithConfig(LaunchConfig{}, x, gamma, beta, y, rows, cols);
+    }
+
+    // blockDim 为 AUTO_BLOCK_DIM 时取 Autotuner::Default() 中以 rows * cols 查到的调优结果，未调优时取 pool.Size()
+    void RunParallel(ThreadPool& pool, std::size_t blockDim, Addr x, Addr gamma, Addr beta, Addr y,
+                     std::size_t rows, std::size_t cols) {
+        RunWithConfig(LaunchConfig{&pool, blockDim}, x, gamma, beta, y, rows, cols);
+    }
+
+    void RunWithConfig(const LaunchConfig& config, Addr x, Addr gamma, Addr beta, Addr y,
+                       std::size_t rows, std::size_t cols) {
+        std::size_t count = rows * cols;
+        std::size_t affineBytes = ((gamma != nullptr) + (beta != nullptr)) * cols * sizeof(T);
+        ScopedLaunch launch(Signature(), RecordKind::LAUNCH, count, 2 * count * sizeof(T) + affineBytes,
+                            count * sizeof(T));
+        if (count == 0) {
+            return;
+        }
+        LaunchConfig resolved = Autotuner::Default().Resolve(Signature(), count, config);
+        std::size_t blockDim = RowBlockDim(resolved, rows);
+        std::size_t tile = detail::NormTileElems<T>(cols, resolved.tileSize);
+        SimLaunch sim(Signature(), count, blockDim, tile, 2 * sizeof(T), sizeof(T), 0.0);
+
+        LaunchRows(resolved, rows, blockDim, [&](std::size_t blockIdx, BlockRange range) {
+            UbScope ub;
+            Buffers buffers{AllocLocal<T>(tile), AllocLocal<T>(tile), AllocLocal<T>(1)};
+            for (std::size_t row = range.offset; row < range.offset + range.count; ++row) {
+                SimTile simTile(sim, blockIdx, cols);
+                ComputeRow(x, gamma, beta, y, row, cols, tile, buffers);
+            }
+        });
+    }
+
+    T Epsilon() const {
+        return epsilon_;
+    }
+
+private:
+    struct Buffers {
+        LocalTensor<T> in;
+        LocalTensor<T> work;
+        LocalTensor<T> scalar;
+    };
+
+    void ComputeRow(Addr x, Addr gamma, Addr beta, Addr y, std::size_t row, std::size_t cols, std::size_t tile,
+                    const Buffers& buffers) const {
+        const LocalTensor<T>& in = buffers.in;
+        const LocalTensor<T>& work = buffers.work;
+        const LocalTensor<T>& scalar = buffers.scalar;
+
+        // 跨 tile 的合并在 double 上进行，tile 内的归约仍由向量指令完成
+        double mean = 0.0;
+        double m2 = 0.0;
+        for (std::size_t offset = 0; offset < cols; offset += tile) {
+            std::size_t len = std::min(tile, cols - offset);
+            DataCopy(in, detail::RowTensor<T>(x, row, offset, cols), len);
+            // 先减去已有的均值（首个 tile 取首元素）再求和，均值远大于标准差时 tile 均值也不丢精度
+            T shift = offset == 0 ? in[0] : static_cast<T>(mean);
+            Adds(work, in, T(-shift), len);
+            ReduceSum(scalar, work, work, len);
+            T shiftedMean = scalar[0] / static_cast<T>(len);
+            Adds(work, work, T(-shiftedMean), len);
+            Mul(work, work, work, len);
+            ReduceSum(scalar, work, work, len);
+
+            double delta = static_cast<double>(shift) + static_cast<double>(shiftedMean) - mean;
+            double total = static_cast<double>(offset + len);
+            mean += delta * len / total;
+            m2 += static_cast<double>(scalar[0]) + delta * delta * offset * len / total;
+        }
+
+        T rstd = static_cast<T>(1.0 / std::sqrt(m2 / cols + static_cast<double>(epsilon_)));
+        for (std::size_t offset = 0; offset < cols; offset += tile) {
+            std::size_t len = std::min(tile, cols - offset);
+            DataCopy(in, detail::RowTensor<T>(x, row, offset, cols), len);
+            Adds(in, in, static_cast<T>(-mean), len);
+            Muls(in, in, rstd, len);
+            if (gamma != nullptr) {
+                DataCopy(work, detail::RowTensor<T>(gamma, 0, offset, cols), len);
+                Mul(in, in, work, len);
+            }
+            if (beta != nullptr) {
+                DataCopy(work, detail::RowTensor<T>(beta, 0, offset, cols), len);
+                Add(in, in, work, len);
+            }
+            DataCopy(detail::RowTensor<T>(y, row, offset, cols), in, len);
+        }
+    }
+
+    T epsilon_;
+};
+
+}
+
+#endif
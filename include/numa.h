@@ -0,0 +1,56 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+struct NumaNode {
+    int id;
+    std::vector<int> cpus;
+};
+
+// NumaTopology：从 /sys/devices/system/node 读取节点与 CPU 的对应关系，不依赖 libnuma
+class NumaTopology {
+public:
+    static constexpr const char* SYS_NODE_PATH = "/sys/devices/system/node";
+
+    // onlyAllowedCpus 为 true 时只保留当前进程可运行的 CPU，并丢弃没有 CPU 的节点（如纯内存节点）
+    // 读取失败时退化为包含全部可用 CPU 的单节点拓扑
+    static NumaTopology Detect(const std::string& sysNodePath = SYS_NODE_PATH, bool onlyAllowedCpus = true);
+
+    static NumaTopology SingleNode(std::size_t cpuCount);
+
+    const std::vector<NumaNode>& Nodes() const {
+        return nodes_;
+    }
+
+    std::size_t NodeCount() const {
+        return nodes_.size();
+    }
+
+    std::size_t CpuCount() const;
+
+    // CPU 所在节点的下标（Nodes() 中的位置），未知 CPU 返回 NodeCount()
+    std::size_t NodeOfCpu(int cpu) const;
+
+private:
+    std::vector<NumaNode> nodes_;
+};
+
+// 解析 cpulist 格式，如 "0-3,8,10-11"
+std::vector<int> ParseCpuList(const std::string& list);
+
+// 把当前线程绑定到给定的 CPU 集合，失败（如 CPU 不存在或无权限）时返回 false
+bool PinCurrentThread(const std::vector<int>& cpus);
+
+}
+
+#endif
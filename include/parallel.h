@@ -0,0 +1,67 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "tuple.h"
+#include "type_list.h"
+#include "thread_pool.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// ParallelTupleForEach：在线程池上并行地对每个元素调用 f，全部完成后返回
+// 适用于彼此独立的逐元素工作，例如初始化或预取每个输入 Tensor
+template <std::size_t I, typename TupleType, typename F>
+void ParallelTupleInvokeAt(TupleType& tuple, F& f) {
+    TupleInvokeElem<I>(f, TupleElemGet<I>(tuple));
+}
+
+template <typename TupleType, typename F, std::size_t... Is>
+void ParallelTupleForEachImpl(ThreadPool& pool, TupleType& tuple, F& f, IndexSequence<Is...>) {
+    using Thunk = void (*)(TupleType&, F&);
+    static constexpr Thunk thunks[] = { &ParallelTupleInvokeAt<Is, TupleType, F>... };
+    pool.ParallelFor(sizeof...(Is), [&tuple, &f](std::size_t i) { thunks[i](tuple, f); });
+}
+
+template <typename TupleType, typename F>
+void ParallelTupleForEach(ThreadPool& pool, TupleType& tuple, F&& f) {
+    constexpr std::size_t size = TupleSize<std::remove_const_t<TupleType>>::value;
+    if constexpr (size > 0) {
+        ParallelTupleForEachImpl(pool, tuple, f, MakeIndexSequence<size>{});
+    }
+}
+
+template <typename TupleType, typename F>
+void ParallelTupleForEach(TupleType& tuple, F&& f) {
+    ParallelTupleForEach(ThreadPool::Default(), tuple, asl::forward<F>(f));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// ParallelApply 元结构：与 TypeList_Apply 相同，但每个 Func<T, I>::execute() 作为独立任务
+// 提交到线程池并等待全部完成，适用于彼此独立的逐类型预热工作
+template <typename List, template <typename, size_t> class Func, size_t Index = 0>
+struct TypeList_ParallelApply;
+
+template <typename... Ts, template <typename, size_t> class Func, size_t Index>
+struct TypeList_ParallelApply<TypeList<Ts...>, Func, Index> {
+    static void execute(ThreadPool& pool = ThreadPool::Default()) {
+        ExecuteImpl(pool, MakeIndexSequence<sizeof...(Ts)>{});
+    }
+
+private:
+    template <size_t... Is>
+    static void ExecuteImpl(ThreadPool& pool, IndexSequence<Is...>) {
+        if constexpr (sizeof...(Is) > 0) {
+            using Entry = void (*)();
+            static constexpr Entry entries[] = { &Func<Ts, Index + Is>::execute... };
+            pool.ParallelFor(sizeof...(Is), [](std::size_t i) { entries[i](); });
+        }
+    }
+};
+
+}
+
+#endif
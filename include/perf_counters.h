@@ -0,0 +1,120 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+enum class PerfEvent {
+    CYCLES,
+    INSTRUCTIONS,
+    LLC_MISSES,     // 末级缓存读缺失
+    DTLB_MISSES,    // 数据 TLB 读缺失
+};
+
+constexpr std::size_t PERF_EVENT_COUNT = 4;
+
+// 一段代码在当前线程上的计数增量；硬件或权限不支持的事件 valid 为 false
+struct PerfSample {
+    std::uint64_t values[PERF_EVENT_COUNT]{};
+    bool valid[PERF_EVENT_COUNT]{};
+
+    std::uint64_t operator[](PerfEvent event) const {
+        return values[static_cast<std::size_t>(event)];
+    }
+};
+
+// 同一 kernel 签名的累计计数
+struct KernelCounters {
+    std::size_t samples{0};         // 计数的 block 数（单 block 执行时即启动次数）
+    std::size_t elements{0};
+    std::uint64_t values[PERF_EVENT_COUNT]{};
+    bool valid[PERF_EVENT_COUNT]{};
+
+    std::uint64_t operator[](PerfEvent event) const {
+        return values[static_cast<std::size_t>(event)];
+    }
+
+    double Ipc() const {
+        std::uint64_t cycles = (*this)[PerfEvent::CYCLES];
+        return cycles == 0 ? 0.0 : static_cast<double>((*this)[PerfEvent::INSTRUCTIONS]) / cycles;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// PerfCounters：基于 perf_event_open 的 kernel 级硬件计数，不需要外部挂载 perf
+// 每个线程第一次计数时打开自己的计数器组（只统计用户态），之后每个 block 前后各读一次；
+// 结果按 kernel 签名累计，Dump 时输出。打开失败（容器内无 PMU、perf_event_paranoid 过高等）时
+// Available() 为 false，计数静默跳过
+class PerfCounters {
+public:
+    static void Enable(bool enabled = true) {
+        Enabled().store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled() {
+        return Enabled().load(std::memory_order_relaxed);
+    }
+
+    // 当前线程能否打开至少一个计数器
+    static bool Available();
+
+    // 读取当前线程计数器组的累计值（按复用时间比例放大）；不可用时返回 false
+    static bool Read(PerfSample& sample);
+
+    static void Accumulate(const char* signature, std::size_t elements, const PerfSample& delta);
+
+    // 按可读的 kernel 签名返回累计结果
+    static std::map<std::string, KernelCounters> Snapshot();
+
+    static void Reset();
+
+    // 文本表格：每个签名一行，含 IPC 与每千元素的缓存 / TLB 缺失
+    static std::string Dump();
+
+private:
+    static std::atomic<bool>& Enabled();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// ScopedCounters：构造与析构时各读一次当前线程的计数器，差值记到 signature 上
+class ScopedCounters {
+public:
+    ScopedCounters(const char* signature, std::size_t elements)
+    : signature_(signature), elements_(elements),
+      active_(PerfCounters::IsEnabled() && PerfCounters::Read(start_)) {
+    }
+
+    ~ScopedCounters() {
+        PerfSample end;
+        if (active_ && PerfCounters::Read(end)) {
+            for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+                end.values[i] = end.valid[i] && start_.valid[i] ? end.values[i] - start_.values[i] : 0;
+                end.valid[i] = end.valid[i] && start_.valid[i];
+            }
+            PerfCounters::Accumulate(signature_, elements_, end);
+        }
+    }
+
+    ScopedCounters(const ScopedCounters&) = delete;
+    ScopedCounters& operator=(const ScopedCounters&) = delete;
+
+private:
+    const char* signature_;
+    std::size_t elements_;
+    PerfSample start_;
+    bool active_;
+};
+
+}
+
+#endif
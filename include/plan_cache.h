@@ -0,0 +1,103 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 当前 CPU 可用的最高向量指令集，计划按它区分：换代机器上的旧计划不会被误用
+enum class IsaVariant : std::uint32_t {
+    SCALAR,
+    AVX2,
+    AVX512,
+};
+
+IsaVariant DetectIsa();
+
+const char* IsaName(IsaVariant isa);
+
+/////////////////////////////////////////////////////////////////////////////////////
+constexpr std::size_t PLAN_MAX_TENSORS = 16;
+
+// 打包地址中每个输入、输出 Tensor 的每元素字节偏移（见 kernel.h 的地址约定）
+struct PlanLayout {
+    std::uint32_t inputCount{0};
+    std::uint32_t outputCount{0};
+    std::uint32_t offsets[PLAN_MAX_TENSORS]{};
+};
+
+// 一条执行计划，定长 POD，文件中按 (signatureHash, countBucket, isa) 升序连续存放
+struct ExecutionPlan {
+    std::uint64_t signatureHash;
+    std::uint32_t countBucket;
+    IsaVariant isa;
+    std::uint32_t blockDim;
+    std::uint32_t reserved;
+    std::uint64_t tileSize;
+    double seconds;
+    PlanLayout layout;
+
+    auto Key() const {
+        return std::make_tuple(signatureHash, countBucket, static_cast<std::uint32_t>(isa));
+    }
+};
+
+// kernel 签名的 64 位 FNV-1a 哈希，文件中只保存哈希
+std::uint64_t PlanSignatureHash(std::string_view signature);
+
+/////////////////////////////////////////////////////////////////////////////////////
+// PlanCache：执行计划的持久化缓存
+// 文件格式为定长文件头加有序的 ExecutionPlan 数组；Open 只做 mmap 与文件头校验，查找直接在映射上二分，
+// 因此启动时不需要解析或重新调优。新插入的计划先放在内存中，Save 时与映射内容合并后原子地替换文件
+class PlanCache {
+public:
+    static constexpr std::uint32_t VERSION = 1;
+
+    PlanCache() = default;
+    ~PlanCache();
+
+    PlanCache(const PlanCache&) = delete;
+    PlanCache& operator=(const PlanCache&) = delete;
+
+    // 映射计划文件，替换之前映射的文件；文件不存在、版本或大小不符时返回 false 并保持为空
+    bool Open(const std::string& path);
+
+    bool Find(std::string_view signature, std::uint32_t countBucket, IsaVariant isa, ExecutionPlan& plan) const;
+
+    // 插入或覆盖同键计划
+    void Insert(const ExecutionPlan& plan);
+
+    // 映射与内存中计划去重后的数量
+    std::size_t Size() const;
+
+    void Clear();
+
+    // 先写临时文件再 rename，正在映射旧文件的进程不受影响
+    bool Save(const std::string& path) const;
+
+private:
+    void Unmap();
+
+private:
+    mutable std::mutex mutex_;
+    const ExecutionPlan* mapped_{nullptr};
+    std::size_t mappedCount_{0};
+    void* mapAddr_{nullptr};
+    std::size_t mapBytes_{0};
+    std::map<std::tuple<std::uint64_t, std::uint32_t, std::uint32_t>, ExecutionPlan> inserted_;
+};
+
+}
+
+#endif
@@ -0,0 +1,108 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+enum class RecordKind {
+    LAUNCH,     // 一次完整的 kernel 启动（调用线程上记录）
+    BLOCK,      // 多核执行时单个 block / chunk（工作线程上记录）
+};
+
+struct LaunchRecord {
+    const char* name;           // typeid(...).name()，静态存储，导出时再 demangle
+    RecordKind kind;
+    std::uint64_t startNs;
+    std::uint64_t endNs;
+    std::uint32_t threadId;     // 记录线程的编号，按线程首次记录的顺序分配
+    std::size_t count;
+    std::size_t bytesRead;
+    std::size_t bytesWritten;
+
+    double Seconds() const {
+        return (endNs - startNs) * 1e-9;
+    }
+
+    // 实际达到的带宽 (bytesRead + bytesWritten) / 耗时，单位 GB/s
+    double GBps() const {
+        return endNs == startNs ? 0.0 : static_cast<double>(bytesRead + bytesWritten) / (endNs - startNs);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Profiler：按需开启的 kernel 启动记录
+// 关闭时每次启动只多一次原子读；开启后记录写入各线程自己的缓冲区，只在 Collect / 导出时加锁合并
+// 也可以通过环境变量 ASL_PROFILE=1 在启动时开启
+class Profiler {
+public:
+    static void Enable(bool enabled = true) {
+        Enabled().store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled() {
+        return Enabled().load(std::memory_order_relaxed);
+    }
+
+    static std::uint64_t NowNs();
+
+    static void Record(const LaunchRecord& record);
+
+    // 合并所有线程（包括已退出线程）的记录，按开始时间排序
+    static std::vector<LaunchRecord> Collect();
+
+    static void Clear();
+
+    // Chrome trace（chrome://tracing、Perfetto）JSON，每条记录是一个 "X" 事件
+    static std::string ChromeTrace();
+
+    static bool WriteChromeTrace(const std::string& path);
+
+    static std::uint32_t CurrentThreadId();
+
+private:
+    static std::atomic<bool>& Enabled();
+};
+
+// typeid(...).name() 的可读形式
+std::string DemangleName(const char* name);
+
+/////////////////////////////////////////////////////////////////////////////////////
+// ScopedLaunch：构造时取开始时间，析构时写入记录；构造时 Profiler 未开启则什么也不做
+class ScopedLaunch {
+public:
+    ScopedLaunch(const char* name, RecordKind kind, std::size_t count, std::size_t bytesRead, std::size_t bytesWritten)
+    : enabled_(Profiler::IsEnabled()) {
+        if (enabled_) {
+            record_ = LaunchRecord{name, kind, Profiler::NowNs(), 0, 0, count, bytesRead, bytesWritten};
+        }
+    }
+
+    ~ScopedLaunch() {
+        if (enabled_) {
+            record_.endNs = Profiler::NowNs();
+            record_.threadId = Profiler::CurrentThreadId();
+            Profiler::Record(record_);
+        }
+    }
+
+    ScopedLaunch(const ScopedLaunch&) = delete;
+    ScopedLaunch& operator=(const ScopedLaunch&) = delete;
+
+private:
+    bool enabled_;
+    LaunchRecord record_{};
+};
+
+}
+
+#endif
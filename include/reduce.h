@@ -0,0 +1,344 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+#include "autotuner.h"
+#include "kernel.h"
+#include "profiler.h"
+#include "row_launch.h"
+#include "simulator.h"
+#include "unified_buffer.h"
+#include "vector_ops.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 沿任意维度的归约：x 为行优先的多维张量，dims 为形状，axes 为要归约的维度下标
+// MEAN 只用于浮点类型，整数类型构造 MEAN 的 Reduce 时抛出 std::invalid_argument（1 / extent 的缩放在整数上截断为 0）
+enum class ReduceOp {
+    SUM,
+    MEAN,
+    MAX,
+    MIN,
+};
+
+// 规整化后的一段维度：去掉长度为 1 的维度后，相邻的同类维度（同为归约或同为保留）合并为一段
+struct ReduceSegment {
+    std::size_t size;
+    bool reduced;
+};
+
+// axes 越界或重复时抛出 std::invalid_argument
+std::vector<ReduceSegment> CollapseReduceAxes(const std::vector<std::size_t>& dims, const std::vector<std::size_t>& axes);
+
+// 输出形状：keepDims 为真时归约的维度保留为 1，否则去掉
+std::vector<std::size_t> ReduceOutputDims(const std::vector<std::size_t>& dims, const std::vector<std::size_t>& axes,
+                                          bool keepDims = false);
+
+// FAST：按 tile 合并，结果的舍入取决于 tileSize 与指令集
+// DETERMINISTIC：按只由归约长度决定的固定二叉树合并，结果与线程数、blockDim、调度方式、tileSize 和指令集都无关，逐位一致
+enum class ReduceMode {
+    FAST,
+    DETERMINISTIC,
+};
+
+// 每个 tile 的默认字节数，LaunchConfig::tileSize 非 0 时以其为 tile 的元素数
+constexpr std::size_t REDUCE_TILE_BYTES = 16 * 1024;
+
+// DETERMINISTIC 模式下叶子的行数：归约维每 REDUCE_LEAF_ROWS 行先在叶子内两两折半合并，叶子的结果再作为下一层的输入
+constexpr std::size_t REDUCE_LEAF_ROWS = 128;
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Reduce：KernelType::REDUCE 的执行器
+// 规整化后从最内的归约段开始逐段归约，每段都是 (outer, extent, inner) 的三维问题，按 inner 分三种向量化方式：
+//   inner == 1（沿最内维）：每行按 tile 搬入，tile 之间逐元素合并，最后对一个 tile 做一次横向归约
+//   inner >= tile（沿外层维，inner 较宽）：按 inner 方向切出宽为 tile 的列块，逐行搬入后逐元素合并，
+//     SIMD 的各 lane 对应不同的输出元素，不需要转置
+//   inner < tile（inner 较窄）：一次搬入 tile / inner 行（在内存中连续），整块逐元素合并，
+//     最后把块内的各行折叠到第一行，使窄的 inner 也能填满向量
+// outer 与列块构成互相独立的任务，按 LaunchConfig 划分给各 block；axes 不连续时（如 {0, 2}）每段的结果写入
+// 临时缓冲，作为下一段的输入
+// DETERMINISTIC 模式下归约维切成 REDUCE_LEAF_ROWS 行的叶子，outer、叶子与列块都是独立的任务，因此即使只有一个输出
+// 也能多线程执行；叶子内与叶子间都按“后一半合并到前一半”逐层折半，只用逐元素指令，合并顺序只由 extent 决定
+// 一次启动的各段共用一个 SimLaunch，每行（inner == 1）或每个任务记录一个 SimTile
+template <typename T>
+class Reduce {
+public:
+    static constexpr KernelType TYPE = KernelType::REDUCE;
+
+    explicit Reduce(ReduceOp op = ReduceOp::SUM, ReduceMode mode = ReduceMode::FAST) : op_(op), mode_(mode) {
+        if (op_ == ReduceOp::MEAN && !std::is_floating_point<T>::value) {
+            throw std::invalid_argument("Reduce: MEAN requires a floating point type");
+        }
+    }
+
+    static const char* Signature() {
+        return typeid(Reduce).name();
+    }
+
+    void Run(Addr x, Addr y, const std::vector<std::size_t>& dims, const std::vector<std::size_t>& axes) {
+        RunWithConfig(LaunchConfig{}, x, y, dims, axes);
+    }
+
+    // blockDim 为 AUTO_BLOCK_DIM 时取 Autotuner::Default() 中以元素总数查到的调优结果，未调优时取 pool.Size()
+    void RunParallel(ThreadPool& pool, std::size_t blockDim, Addr x, Addr y, const std::vector<std::size_t>& dims,
+                     const std::vector<std::size_t>& axes) {
+        RunWithConfig(LaunchConfig{&pool, blockDim}, x, y, dims, axes);
+    }
+
+    void RunWithConfig(const LaunchConfig& config, Addr x, Addr y, const std::vector<std::size_t>& dims,
+                       const std::vector<std::size_t>& axes) {
+        std::vector<ReduceSegment> segments = CollapseReduceAxes(dims, axes);
+        std::size_t inCount = 1;
+        std::size_t outCount = 1;
+        for (auto& segment : segments) {
+            inCount *= segment.size;
+            outCount *= segment.reduced ? 1 : segment.size;
+        }
+        ScopedLaunch launch(Signature(), RecordKind::LAUNCH, inCount, inCount * sizeof(T), outCount * sizeof(T));
+
+        T* src = reinterpret_cast<T*>(x);
+        T* out = reinterpret_cast<T*>(y);
+        if (outCount == 0) {
+            return;
+        }
+        if (inCount == 0) {
+            std::fill_n(out, outCount, Identity());
+            return;
+        }
+        T scale = op_ == ReduceOp::MEAN ? static_cast<T>(static_cast<double>(outCount) / inCount) : T(1);
+
+        std::vector<T> temps[2];
+        std::size_t flip = 0;
+        auto last = std::find_if(segments.rbegin(), segments.rend(), [](const ReduceSegment& s) { return s.reduced; });
+        if (last == segments.rend()) {
+            std::copy_n(src, outCount, out);
+            return;
+        }
+        LaunchConfig resolved = Autotuner::Default().Resolve(Signature(), inCount, config);
+        SimLaunch sim(Signature(), inCount, RowBlockDim(resolved, inCount), TileElems(resolved), sizeof(T), 0, 0.0);
+        while (last != segments.rend()) {
+            std::size_t index = segments.rend() - last - 1;
+            std::size_t outer = 1;
+            std::size_t inner = 1;
+            for (std::size_t i = 0; i < segments.size(); ++i) {
+                outer *= i < index ? segments[i].size : 1;
+                inner *= i > index ? segments[i].size : 1;
+            }
+            std::size_t extent = segments[index].size;
+            segments.erase(segments.begin() + index);
+            last = std::find_if(segments.rbegin(), segments.rend(), [](const ReduceSegment& s) { return s.reduced; });
+
+            bool final = last == segments.rend();
+            T* dst = out;
+            if (!final) {
+                temps[flip].resize(outer * inner);
+                dst = temps[flip].data();
+                flip ^= 1;
+            }
+            if (mode_ == ReduceMode::DETERMINISTIC) {
+                ReduceAxisDeterministic(resolved, sim, src, dst, outer, extent, inner, final ? scale : T(1));
+            } else {
+                ReduceAxis(resolved, sim, src, dst, outer, extent, inner, final ? scale : T(1));
+            }
+            src = dst;
+        }
+    }
+
+    ReduceOp Op() const {
+        return op_;
+    }
+
+    ReduceMode Mode() const {
+        return mode_;
+    }
+
+private:
+    T Identity() const {
+        switch (op_) {
+        case ReduceOp::MAX:
+            return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                        : std::numeric_limits<T>::lowest();
+        case ReduceOp::MIN:
+            return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                        : std::numeric_limits<T>::max();
+        default:
+            return T(0);
+        }
+    }
+
+    // dst = combine(src0, src1)，逐元素
+    void Combine(const LocalTensor<T>& dst, const LocalTensor<T>& src0, const LocalTensor<T>& src1,
+                 std::size_t count) const {
+        switch (op_) {
+        case ReduceOp::SUM:
+        case ReduceOp::MEAN: Add(dst, src0, src1, count); break;
+        case ReduceOp::MAX:  Max(dst, src0, src1, count); break;
+        case ReduceOp::MIN:  Min(dst, src0, src1, count); break;
+        }
+    }
+
+    // src 前 count 个元素的横向归约
+    T Horizontal(const LocalTensor<T>& src, const LocalTensor<T>& work, const LocalTensor<T>& scalar,
+                 std::size_t count) const {
+        switch (op_) {
+        case ReduceOp::SUM:
+        case ReduceOp::MEAN:
+            ReduceSum(scalar, src, work, count);
+            return scalar[0];
+        case ReduceOp::MAX:
+            ReduceMax(scalar, src, work, count);
+            return scalar[0];
+        case ReduceOp::MIN:
+            break;
+        }
+        // 没有 ReduceMin 指令，逐层折半
+        Fold(src, count, 1);
+        return src[0];
+    }
+
+    // buf 中 rows 行、每行 width 个元素：每层把后 rows / 2 行合并到前 rows / 2 行，直到只剩第一行
+    void Fold(const LocalTensor<T>& buf, std::size_t rows, std::size_t width) const {
+        while (rows > 1) {
+            std::size_t half = rows / 2;
+            Combine(buf, buf, Slice(buf, (rows - half) * width, half * width), half * width);
+            rows -= half;
+        }
+    }
+
+    static LocalTensor<T> Slice(const LocalTensor<T>& tensor, std::size_t offset, std::size_t count) {
+        return LocalTensor<T>{tensor.data + offset, count * sizeof(T)};
+    }
+
+    static Tensor<T> Gm(T* data, std::size_t count) {
+        return Tensor<T>{data, count * sizeof(T)};
+    }
+
+    static std::size_t TileElems(const LaunchConfig& config) {
+        return std::max<std::size_t>(config.tileSize == 0 ? REDUCE_TILE_BYTES / sizeof(T) : config.tileSize, 1);
+    }
+
+    void ReduceAxis(const LaunchConfig& config, SimLaunch& sim, T* src, T* dst, std::size_t outer, std::size_t extent,
+                    std::size_t inner, T scale) const {
+        std::size_t tile = TileElems(config);
+        if (inner == 1) {
+            tile = std::min(tile, extent);
+            LaunchRows(config, outer, RowBlockDim(config, outer), [&](std::size_t blockIdx, BlockRange range) {
+                UbScope ub;
+                LocalTensor<T> acc = AllocLocal<T>(tile);
+                LocalTensor<T> in = AllocLocal<T>(tile);
+                LocalTensor<T> scalar = AllocLocal<T>(1);
+                for (std::size_t row = range.offset; row < range.offset + range.count; ++row) {
+                    SimTile simTile(sim, blockIdx, extent);
+                    T* base = src + row * extent;
+                    DataCopy(acc, Gm(base, tile), tile);
+                    for (std::size_t offset = tile; offset < extent; offset += tile) {
+                        std::size_t len = std::min(tile, extent - offset);
+                        DataCopy(in, Gm(base + offset, len), len);
+                        Combine(acc, acc, in, len);
+                    }
+                    dst[row] = Horizontal(acc, in, scalar, tile) * scale;
+                }
+            });
+            return;
+        }
+
+        // 每次合并 rowsPerStep 行、每行 width 个元素；rowsPerStep > 1 时 width == inner，这些行在内存中连续
+        std::size_t width = std::min(inner, tile);
+        std::size_t rowsPerStep = std::min(std::max<std::size_t>(tile / inner, 1), extent);
+        std::size_t colTiles = (inner + width - 1) / width;
+        std::size_t tasks = outer * colTiles;
+        LaunchRows(config, tasks, RowBlockDim(config, tasks), [&](std::size_t blockIdx, BlockRange range) {
+            UbScope ub;
+            LocalTensor<T> acc = AllocLocal<T>(rowsPerStep * width);
+            LocalTensor<T> in = AllocLocal<T>(rowsPerStep * width);
+            for (std::size_t task = range.offset; task < range.offset + range.count; ++task) {
+                std::size_t o = task / colTiles;
+                std::size_t col = task % colTiles * width;
+                std::size_t w = std::min(width, inner - col);
+                SimTile simTile(sim, blockIdx, extent * w);
+                T* base = src + o * extent * inner + col;
+
+                DataCopy(acc, Gm(base, rowsPerStep * w), rowsPerStep * w);
+                for (std::size_t r = rowsPerStep; r < extent; r += rowsPerStep) {
+                    std::size_t len = std::min(rowsPerStep, extent - r) * w;
+                    DataCopy(in, Gm(base + r * inner, len), len);
+                    Combine(acc, acc, in, len);
+                }
+                for (std::size_t r = 1; r < rowsPerStep; ++r) {
+                    Combine(acc, acc, Slice(acc, r * w, w), w);
+                }
+                if (scale != T(1)) {
+                    Muls(acc, acc, scale, w);
+                }
+                DataCopy(Gm(dst + o * inner + col, w), acc, w);
+            }
+        });
+    }
+
+    // 每个任务把一个叶子（至多 REDUCE_LEAF_ROWS 行）的一个列块折半合并为一行；叶子多于一个时，
+    // 各叶子的结果组成 (outer, leaves, inner) 的新问题继续归约。tileSize 只影响列块宽度，不改变任何输出的合并顺序
+    void ReduceAxisDeterministic(const LaunchConfig& config, SimLaunch& sim, T* src, T* dst, std::size_t outer,
+                                 std::size_t extent, std::size_t inner, T scale) const {
+        std::size_t tile = config.tileSize == 0 ? REDUCE_TILE_BYTES / sizeof(T) : config.tileSize;
+        std::size_t leaves = (extent + REDUCE_LEAF_ROWS - 1) / REDUCE_LEAF_ROWS;
+        std::vector<T> partial;
+        T* out = dst;
+        if (leaves > 1) {
+            partial.resize(outer * leaves * inner);
+            out = partial.data();
+        }
+
+        std::size_t width = std::min(std::max<std::size_t>(tile / REDUCE_LEAF_ROWS, 1), inner);
+        std::size_t colTiles = (inner + width - 1) / width;
+        std::size_t tasks = outer * leaves * colTiles;
+        LaunchRows(config, tasks, RowBlockDim(config, tasks), [&](std::size_t blockIdx, BlockRange range) {
+            UbScope ub;
+            LocalTensor<T> buf = AllocLocal<T>(REDUCE_LEAF_ROWS * width);
+            for (std::size_t task = range.offset; task < range.offset + range.count; ++task) {
+                std::size_t col = task % colTiles * width;
+                std::size_t leaf = task / colTiles % leaves;
+                std::size_t o = task / colTiles / leaves;
+                std::size_t w = std::min(width, inner - col);
+                std::size_t rows = std::min(REDUCE_LEAF_ROWS, extent - leaf * REDUCE_LEAF_ROWS);
+                T* base = src + (o * extent + leaf * REDUCE_LEAF_ROWS) * inner + col;
+                SimTile simTile(sim, blockIdx, rows * w);
+
+                // w == inner 时叶子的各行在内存中连续
+                if (w == inner) {
+                    DataCopy(buf, Gm(base, rows * w), rows * w);
+                } else {
+                    for (std::size_t r = 0; r < rows; ++r) {
+                        DataCopy(Slice(buf, r * w, w), Gm(base + r * inner, w), w);
+                    }
+                }
+                Fold(buf, rows, w);
+                if (leaves == 1 && scale != T(1)) {
+                    Muls(buf, buf, scale, w);
+                }
+                DataCopy(Gm(out + (o * leaves + leaf) * inner + col, w), buf, w);
+            }
+        });
+
+        if (leaves > 1) {
+            ReduceAxisDeterministic(config, sim, partial.data(), dst, outer, leaves, inner, scale);
+        }
+    }
+
+    ReduceOp op_;
+    ReduceMode mode_;
+};
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "elem_wise.h"
+#include "index_seq.h"
+#include "profiler.h"
+#include "thread_pool.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 机器的实测峰值：内存带宽（GB/s）与浮点吞吐（GFLOP/s）
+struct MachinePeak {
+    double bandwidthGBps{0.0};
+    double gflops{0.0};
+
+    // 脊点：算术强度（FLOP/Byte）低于它的 kernel 受带宽限制
+    double RidgeIntensity() const {
+        return bandwidthGBps == 0.0 ? 0.0 : gflops / bandwidthGBps;
+    }
+};
+
+// 在 pool 的全部线程上测量峰值：带宽用 triad (a = b + s * c) 扫描每线程 bytesPerThread 字节，
+// 浮点用互不依赖的乘加链；各自重复 repeat 次取最好成绩
+MachinePeak MeasureMachinePeak(ThreadPool& pool, std::size_t bytesPerThread = std::size_t(64) << 20, std::size_t repeat = 3);
+
+/////////////////////////////////////////////////////////////////////////////////////
+struct RooflinePoint {
+    std::string name;
+    double flopsPerElem;
+    double bytesPerElem;
+    std::size_t count;
+    double seconds;
+
+    // 算术强度 FLOP/Byte
+    double Intensity() const {
+        return bytesPerElem == 0.0 ? 0.0 : flopsPerElem / bytesPerElem;
+    }
+
+    double Gflops() const {
+        return seconds == 0.0 ? 0.0 : flopsPerElem * count / seconds * 1e-9;
+    }
+
+    double GBps() const {
+        return seconds == 0.0 ? 0.0 : bytesPerElem * count / seconds * 1e-9;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// RooflineReport：把 kernel 的实测吞吐放到 roofline 上
+// 受带宽限制的 kernel 以带宽占峰值的比例衡量效率，受算力限制的以浮点吞吐占峰值的比例衡量
+class RooflineReport {
+public:
+    explicit RooflineReport(const MachinePeak& peak) : peak_(peak) {}
+
+    const MachinePeak& Peak() const {
+        return peak_;
+    }
+
+    void Add(const RooflinePoint& point) {
+        points_.push_back(point);
+    }
+
+    const std::vector<RooflinePoint>& Points() const {
+        return points_;
+    }
+
+    bool MemoryBound(const RooflinePoint& point) const {
+        return point.Intensity() < peak_.RidgeIntensity();
+    }
+
+    // 该算术强度下可达到的最高 GFLOP/s：min(峰值算力, 强度 * 峰值带宽)
+    double AttainableGflops(const RooflinePoint& point) const {
+        return std::min(peak_.gflops, point.Intensity() * peak_.bandwidthGBps);
+    }
+
+    double Efficiency(const RooflinePoint& point) const;
+
+    // 以 RunParallel(pool, pool.Size(), ...) 执行 KERNEL，count 个元素，重复 repeat 次取最快的一次
+    // 所有输入共用一块打包内存，所有输出共用另一块（见 kernel.h 的地址约定）；只适用于不带属性参数的 kernel
+    template <typename KERNEL>
+    void Measure(ThreadPool& pool, const std::string& name, std::size_t count, std::size_t repeat = 5) {
+        std::vector<unsigned char> inputs(KERNEL::IN_BYTES * count, 1);
+        std::vector<unsigned char> outputs(KERNEL::OUT_BYTES * count, 0);
+        KERNEL kernel;
+
+        double best = 0.0;
+        for (std::size_t i = 0; i < std::max<std::size_t>(repeat, 1); ++i) {
+            std::uint64_t start = Profiler::NowNs();
+            RunPacked(kernel, pool, inputs.data(), outputs.data(), count,
+                      MakeIndexSequence<KERNEL::INPUT_COUNT>{}, MakeIndexSequence<KERNEL::OUTPUT_COUNT>{});
+            double seconds = (Profiler::NowNs() - start) * 1e-9;
+            best = (i == 0 || seconds < best) ? seconds : best;
+        }
+        Add(RooflinePoint{name, KERNEL::FLOPS_PER_ELEM, static_cast<double>(KERNEL::IN_BYTES + KERNEL::OUT_BYTES),
+                          count, best});
+    }
+
+    // 文本表格：每个 kernel 一行，含强度、实测吞吐、可达上限、瓶颈与效率
+    std::string Format() const;
+
+private:
+    template <typename KERNEL, std::size_t... Is, std::size_t... Os>
+    static void RunPacked(KERNEL& kernel, ThreadPool& pool, Addr in, Addr out, std::size_t count,
+                          IndexSequence<Is...>, IndexSequence<Os...>) {
+        kernel.RunParallel(pool, pool.Size(), ((void)Is, in)..., ((void)Os, out)..., count);
+    }
+
+private:
+    MachinePeak peak_;
+    std::vector<RooflinePoint> points_;
+};
+
+// 测量库中预先实例化的全部 ElemWise kernel（见 kernel_ops.h）
+void MeasurePrebuiltKernels(RooflineReport& report, ThreadPool& pool, std::size_t count);
+
+}
+
+#endif
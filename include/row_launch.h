@@ -0,0 +1,61 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef ROW_LAUNCH_H
+#define ROW_LAUNCH_H
+
+#include <algorithm>
+#include <cstddef>
+#include "kernel.h"
+#include "thread_pool.h"
+#include "tiling.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 按行调度的 kernel（Softmax、LayerNorm、Reduce 等）共用的启动逻辑：以整行为单位划分 block，
+// 一行不会被拆到两个 block 中，行内的统计量因此只在一个线程上累计
+
+// 实际使用的 block 数：pool 为空时为 1，且不超过行数
+// 调用方应先以 Autotuner::Default().Resolve 把 AUTO_BLOCK_DIM 替换为调优结果，未经解析的 AUTO_BLOCK_DIM 取 pool.Size()
+inline std::size_t RowBlockDim(const LaunchConfig& config, std::size_t rows) {
+    std::size_t blockDim = config.pool == nullptr ? 1
+                         : (config.blockDim == AUTO_BLOCK_DIM ? config.pool->Size() : config.blockDim);
+    return std::max<std::size_t>(std::min(blockDim, rows), 1);
+}
+
+// 把 [0, rows) 划分为 blockDim 个 block，按 config.schedule 以 f(blockIdx, BlockRange) 执行各 block 的行区间；
+// STEALING 时每个 block 再细分为 STEAL_CHUNKS_PER_BLOCK 段，f 对同一 blockIdx 可能被调用多次
+template <typename F>
+void LaunchRows(const LaunchConfig& config, std::size_t rows, std::size_t blockDim, F&& f) {
+    auto runBlock = [&](std::size_t blockIdx, BlockRange range) {
+        if (range.count == 0) {
+            return;
+        }
+        BlockScope scope(blockIdx, blockDim);
+        f(blockIdx, range);
+    };
+    if (config.pool == nullptr) {
+        for (std::size_t blockIdx = 0; blockIdx < blockDim; ++blockIdx) {
+            runBlock(blockIdx, BlockPartition(rows, blockDim, blockIdx, 1));
+        }
+        return;
+    }
+    if (config.schedule == LaunchSchedule::STATIC) {
+        config.pool->Dispatch(blockDim, [&](std::size_t blockIdx) {
+            runBlock(blockIdx, BlockPartition(rows, blockDim, blockIdx, 1));
+        });
+        return;
+    }
+    config.pool->DispatchStealing(blockDim, STEAL_CHUNKS_PER_BLOCK, [&](std::size_t chunkIdx) {
+        std::size_t blockIdx = chunkIdx / STEAL_CHUNKS_PER_BLOCK;
+        BlockRange block = BlockPartition(rows, blockDim, blockIdx, 1);
+        BlockRange chunk = BlockPartition(block.count, STEAL_CHUNKS_PER_BLOCK, chunkIdx % STEAL_CHUNKS_PER_BLOCK, 1);
+        runBlock(blockIdx, BlockRange{block.offset + chunk.offset, chunk.count});
+    });
+}
+
+}
+
+#endif
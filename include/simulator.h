@@ -0,0 +1,179 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "kernel.h"
+#include "profiler.h"
+#include "unified_buffer.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 类 AI Core 的机器模型，默认值取自常见训练卡的量级，按目标型号修改
+// 每个核有独立的搬入（MTE2：GM -> UB）、向量计算（Vector）、搬出（MTE3：UB -> GM）三条流水，
+// 所有核共享 GM 带宽
+struct MachineModel {
+    std::size_t coreNum{40};
+    double clockGHz{1.8};
+    double gmBandwidthGBps{1600.0};     // 全部核共享的 GM 带宽
+    double mteBytesPerCycle{64.0};      // 单核单方向的搬运带宽
+    double vectorOpsPerCycle{64.0};     // 单核每周期完成的向量运算元素数
+    double copyLatencyCycles{500.0};    // 每次 DataCopy 的固定开销
+    double launchOverheadUs{5.0};       // kernel 下发开销
+    bool doubleBuffer{true};            // 搬运与计算以两块缓冲交替进行（AscendC 的 BUFFER_NUM = 2）
+};
+
+// 单个 tile 的工作量
+struct TileCost {
+    std::size_t copyInBytes;
+    std::size_t copyOutBytes;
+    std::size_t vectorOps;
+};
+
+// 各 block 的 tile 序列，blocks[b][t] 为第 b 个 block 的第 t 个 tile
+using SimWorkload = std::vector<std::vector<TileCost>>;
+
+enum class SimBound {
+    MTE_IN,
+    VECTOR,
+    MTE_OUT,
+    GM_BANDWIDTH,
+};
+
+const char* SimBoundName(SimBound bound);
+
+struct SimEstimate {
+    double seconds{0.0};
+    double cycles{0.0};             // 最慢的核从第一次搬入到最后一次搬出的周期数
+    std::size_t waves{0};           // block 数超过核数时按轮次执行
+    SimBound bound{SimBound::VECTOR};
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 一次 kernel 启动的估算结果与 host 上的实测耗时
+struct SimRecord {
+    const char* name;
+    std::size_t count;
+    std::size_t blockDim;
+    std::size_t tileSize;
+    double hostSeconds;
+    SimEstimate estimate;
+};
+
+// Simulator：按机器模型估算 kernel 在设备上的耗时
+// 第 b 个 block 由第 b % coreNum 个核执行，同一个核上的 block 依次执行；每个 block 内的 tile 按三级流水
+// （搬入 -> 计算 -> 搬出）逐周期推演，开启 doubleBuffer 时相邻 tile 的搬运与计算重叠；最后再与共享 GM 带宽的下限取最大值
+// 开启后（Enable 或环境变量 ASL_SIMULATE=1）每次 ElemWise 启动都会按 tile 记录 DataCopy 字节数与向量运算数并估算，
+// OP 未经 DataCopy 直接访问 GM 的 tile 按 IN_BYTES / OUT_BYTES 计搬运，未记录向量运算的按 OPS_PER_ELEM 计
+class Simulator {
+public:
+    static void Enable(bool enabled = true) {
+        Enabled().store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled() {
+        return Enabled().load(std::memory_order_relaxed);
+    }
+
+    static void SetModel(const MachineModel& model);
+
+    static MachineModel Model();
+
+    static SimEstimate Estimate(const MachineModel& model, const SimWorkload& workload);
+
+    // 不执行 kernel，按 ElemWise 的 block / tile 划分和每元素的字节数、运算数直接估算，用于快速比较 tiling 候选
+    static SimEstimate EstimateElemWise(const MachineModel& model, std::size_t count, std::size_t blockDim,
+                                        std::size_t tileSize, std::size_t inBytesPerElem,
+                                        std::size_t outBytesPerElem, double opsPerElem);
+
+    static void Record(const SimRecord& record);
+
+    static std::vector<SimRecord> Records();
+
+    static void Clear();
+
+    // 文本表格：每次启动一行，实测耗时与估算耗时并列
+    static std::string Report();
+
+private:
+    static std::atomic<bool>& Enabled();
+};
+
+// 开启 Simulator，以 pool.Size() 个 block 和每个 tileSize 执行库中预先实例化的全部 ElemWise kernel（见 kernel_ops.h），
+// 结果通过 Simulator::Report 查看
+void SimulatePrebuiltKernels(ThreadPool& pool, std::size_t count, const std::vector<std::size_t>& tileSizes);
+
+/////////////////////////////////////////////////////////////////////////////////////
+// SimLaunch：一次启动的 tile 记录，析构时估算并写入 Simulator；构造时 Simulator 未开启则什么也不做
+class SimLaunch {
+public:
+    SimLaunch(const char* name, std::size_t count, std::size_t blockDim, std::size_t tileSize,
+              std::size_t inBytesPerElem, std::size_t outBytesPerElem, double opsPerElem);
+    ~SimLaunch();
+
+    SimLaunch(const SimLaunch&) = delete;
+    SimLaunch& operator=(const SimLaunch&) = delete;
+
+    bool Active() const {
+        return active_;
+    }
+
+    // 可由多个线程调用（工作窃取时同一 block 的 chunk 可能在不同线程上执行）
+    void RecordTile(std::size_t blockIdx, std::size_t elements, const TileCost& cost);
+
+private:
+    bool active_;
+    const char* name_;
+    std::size_t count_;
+    std::size_t blockDim_;
+    std::size_t tileSize_;
+    std::size_t inBytesPerElem_;
+    std::size_t outBytesPerElem_;
+    double opsPerElem_;
+    std::uint64_t startNs_{0};
+    std::mutex mutex_;
+    SimWorkload workload_;
+};
+
+// SimTile：在执行 tile 的线程上记录该 tile 前后 UB 统计的差值
+class SimTile {
+public:
+    SimTile(SimLaunch& launch, std::size_t blockIdx, std::size_t elements)
+    : launch_(launch), blockIdx_(blockIdx), elements_(elements) {
+        if (launch_.Active()) {
+            UnifiedBuffer& ub = UnifiedBuffer::Current();
+            start_ = TileCost{ub.CopyInBytes(), ub.CopyOutBytes(), ub.VectorOps()};
+        }
+    }
+
+    ~SimTile() {
+        if (launch_.Active()) {
+            UnifiedBuffer& ub = UnifiedBuffer::Current();
+            launch_.RecordTile(blockIdx_, elements_, TileCost{ub.CopyInBytes() - start_.copyInBytes,
+                                                              ub.CopyOutBytes() - start_.copyOutBytes,
+                                                              ub.VectorOps() - start_.vectorOps});
+        }
+    }
+
+    SimTile(const SimTile&) = delete;
+    SimTile& operator=(const SimTile&) = delete;
+
+private:
+    SimLaunch& launch_;
+    std::size_t blockIdx_;
+    std::size_t elements_;
+    TileCost start_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "chase_lev_deque.h"
+#include "numa.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// ThreadPool：固定数量的工作线程，执行独立的 kernel 子任务
+// 每个工作线程拥有一个 Chase-Lev 双端队列，工作线程内产生的子任务压入自己的队列，
+// 空闲线程优先从同一 NUMA 节点的其他线程窃取，再跨节点窃取；外部线程提交的任务进入共享队列
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threadNum = DefaultThreadNum());
+
+    // NUMA 感知：按节点顺序创建工作线程（节点 0 的线程下标最小），每个线程绑定到所在节点的 CPU 集合
+    // 配合 Dispatch 的 "block b -> 线程 b % Size()" 映射，相邻的 block 落在同一节点上，
+    // 再由 ElemWise::FirstTouch 首次访问，即可保证每个节点只处理自身内存上的数据
+    // threadsPerNode 为 0 时每个节点的线程数等于该节点的 CPU 数
+    explicit ThreadPool(const NumaTopology& topology, std::size_t threadsPerNode = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t Size() const {
+        return workers_.size();
+    }
+
+    // 提交单个任务，通过 future 获取结果或异常
+    template <typename F>
+    auto Submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        auto future = task->get_future();
+        Post([task]() { (*task)(); });
+        return future;
+    }
+
+    // 并行执行 f(0) ... f(n - 1) 并等待全部完成
+    // 调用线程同样参与执行，因此在工作线程内嵌套调用也不会死锁；首个异常会被重新抛出
+    void ParallelFor(std::size_t n, const std::function<void(std::size_t)>& f);
+
+    // 将 f(i) 固定派发给第 i % Size() 个工作线程执行并等待全部完成，调用线程不参与执行
+    // 用于需要稳定 "任务 -> 线程" 映射的场景，例如首次访问（first touch）与后续计算由同一线程完成
+    // 在本线程池的工作线程内调用时退化为 ParallelFor，以避免等待自身而死锁
+    void Dispatch(std::size_t n, const std::function<void(std::size_t)>& f);
+
+    // 工作窃取版本的 Dispatch：第 i 个任务同样先交给第 i % Size() 个工作线程，但再细分为 chunks 个 chunk，
+    // 以 f(i * chunks + k) 调用。所属线程把 chunk 区间不断二分，右半部分压入自己的队列、继续处理左半部分，
+    // 空闲线程从队列顶端窃取剩余的最大区间，因此 chunk 代价不均（尾块、缺页等）时会自动重新平衡
+    // 在本线程池的工作线程内调用时退化为 ParallelFor
+    void DispatchStealing(std::size_t n, std::size_t chunks, const std::function<void(std::size_t)>& f);
+
+    // 当前线程在本线程池中的下标；非本线程池的线程返回 Size()
+    std::size_t CurrentWorker() const;
+
+    // 工作线程所在的 NUMA 节点下标；非 NUMA 感知的线程池只有一个节点
+    std::size_t NodeOfWorker(std::size_t worker) const {
+        return workerNodes_[worker];
+    }
+
+    std::size_t NodeCount() const {
+        return nodeCount_;
+    }
+
+    // 进程内共享的默认线程池，检测到多个 NUMA 节点时按节点绑定工作线程
+    static ThreadPool& Default();
+
+    static std::size_t DefaultThreadNum();
+
+private:
+    using Job = std::function<void()>;
+    struct StealingState;
+
+    void Post(Job task);
+    void PostTo(std::size_t worker, Job task);
+    // 工作线程内压入自己的队列，其他线程调用时进入共享队列
+    void Spawn(Job task);
+    void SplitRange(const std::shared_ptr<StealingState>& state, std::size_t begin, std::size_t end);
+    void Start(std::vector<std::size_t> workerNodes, std::vector<std::vector<int>> workerCpus);
+    void WorkerLoop(std::size_t worker);
+    Job* TakeShared(std::size_t worker);
+    Job* StealFor(std::size_t worker);
+    static void RunJob(Job* job);
+
+private:
+    std::vector<std::thread> workers_;
+    std::vector<std::size_t> workerNodes_;
+    std::vector<std::vector<int>> workerCpus_;
+    // 每个线程的窃取顺序：同节点的其他线程在前，其他节点在后
+    std::vector<std::vector<std::size_t>> victims_;
+    std::vector<std::unique_ptr<ChaseLevDeque<Job*>>> localJobs_;
+    std::size_t nodeCount_{1};
+    std::deque<Job*> tasks_;
+    std::vector<std::deque<Job*>> pinnedTasks_;
+    std::atomic<std::size_t> sleepers_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_{false};
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef TILING_H
+#define TILING_H
+
+#include <cstddef>
+#include <type_traits>
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// host 侧 tiling 函数的输入输出，对应 CANN 的 TilingContext
+// blockDim、tileSize 的初值来自启动配置（或 Autotuner），tiling 函数可以改写，执行器按改写后的值划分
+struct TilingContext {
+    std::size_t count;
+    std::size_t coreNum;            // 可用的执行线程数，单线程执行时为 1
+    std::size_t inBytesPerElem;
+    std::size_t outBytesPerElem;
+    std::size_t blockDim;
+    std::size_t tileSize;
+};
+
+struct NoTilingData {};
+
+// KernelTiling：OP 的 tiling 注册表
+// OP 在类内声明 POD 的 TilingData 与 static void Tiling(TilingContext&, TilingData&) 即自动注册，
+// 也可以用 ASL_REGISTER_TILING 把已有的 tiling 函数注册给 OP；注册后执行器以
+// OP(inTensors..., outTensors..., tempTensors..., count, const TilingData&, attrs...) 调用
+template <typename OP, typename = void>
+struct KernelTiling {
+    static constexpr bool ENABLED = false;
+    using Data = NoTilingData;
+
+    static void Compute(TilingContext&, Data&) {}
+};
+
+template <typename OP>
+struct KernelTiling<OP, std::void_t<typename OP::TilingData, decltype(&OP::Tiling)>> {
+    static constexpr bool ENABLED = true;
+    using Data = typename OP::TilingData;
+
+    static_assert(std::is_trivially_copyable<Data>::value && std::is_standard_layout<Data>::value,
+                  "TilingData should be POD!");
+
+    static void Compute(TilingContext& context, Data& data) {
+        OP::Tiling(context, data);
+    }
+};
+
+// 在全局命名空间使用：ASL_REGISTER_TILING(MyOp, MyTilingData, MyTilingFunc)
+#define ASL_REGISTER_TILING(OP, DATA, FUNC)                                             \
+namespace asl {                                                                         \
+template <>                                                                             \
+struct KernelTiling<OP, void> {                                                         \
+    static constexpr bool ENABLED = true;                                               \
+    using Data = DATA;                                                                  \
+    static_assert(std::is_trivially_copyable<Data>::value &&                            \
+                  std::is_standard_layout<Data>::value, "TilingData should be POD!");   \
+    static void Compute(TilingContext& context, Data& data) {                           \
+        FUNC(context, data);                                                            \
+    }                                                                                   \
+};                                                                                      \
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 当前线程正在执行的 block 下标与 block 总数，对应 AscendC 的 GetBlockIdx / GetBlockNum
+// 不在 kernel 执行中时分别为 0 与 1
+std::size_t GetBlockIdx();
+std::size_t GetBlockNum();
+
+// 执行器在每个 block 前设置，析构时恢复外层的值（支持嵌套启动）
+class BlockScope {
+public:
+    BlockScope(std::size_t blockIdx, std::size_t blockNum);
+    ~BlockScope();
+
+    BlockScope(const BlockScope&) = delete;
+    BlockScope& operator=(const BlockScope&) = delete;
+
+private:
+    std::size_t savedIdx_;
+    std::size_t savedNum_;
+};
+
+}
+
+#endif
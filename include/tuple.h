@@ -5,22 +5,82 @@
 #ifndef TUPLE_H
 #define TUPLE_H
 
+#include <type_traits>
+#include <utility>
 #include "type_list.h"
 #include "forward.h"
+#include "index_seq.h"
 
 namespace asl {
 
 /////////////////////////////////////////////////////////////////////////////////////
 template <typename... Ts>
-struct Tuple {};
+struct Tuple;
+
+// 分段构造标签：每个元素由对应的参数 Tuple 原地构造
+struct PiecewiseConstructT {
+    explicit PiecewiseConstructT() = default;
+};
+
+inline constexpr PiecewiseConstructT PIECEWISE_CONSTRUCT{};
+
+// 用参数 Tuple 中的元素直接构造 T（定义见下文）
+template <typename T, typename ArgsTuple>
+constexpr T MakeFromTuple(ArgsTuple&& args);
 
 template <typename T, typename... Ts>
 struct Tuple<T, Ts...> {
     T head;
     Tuple<Ts...> tail;
-    
+
     Tuple() : head(), tail() {}
-    Tuple(T&& h, Ts&&... ts) : head(asl::forward<T>(h)), tail(asl::forward<Ts>(ts)...) {}
+
+    // 完美转发的逐元素构造：实参可以是左值或可转换为元素类型的任意值
+    template <typename U, typename... Us,
+              typename = std::enable_if_t<sizeof...(Us) == sizeof...(Ts) &&
+                                          !std::is_same_v<std::decay_t<U>, PiecewiseConstructT>>>
+    Tuple(U&& h, Us&&... ts) : head(asl::forward<U>(h)), tail(asl::forward<Us>(ts)...) {}
+
+    // 从元素类型可转换的另一个 Tuple 构造
+    template <typename U, typename... Us,
+              typename = std::enable_if_t<sizeof...(Us) == sizeof...(Ts)>>
+    Tuple(const Tuple<U, Us...>& other) : head(other.head), tail(other.tail) {}
+
+    template <typename U, typename... Us,
+              typename = std::enable_if_t<sizeof...(Us) == sizeof...(Ts)>>
+    Tuple(Tuple<U, Us...>&& other) : head(asl::forward<U>(other.head)), tail(std::move(other.tail)) {}
+
+    // 分段构造：Tuple(PIECEWISE_CONSTRUCT, ForwardAsTuple(args0...), ForwardAsTuple(args1...), ...)
+    template <typename HeadArgs, typename... TailArgs,
+              typename = std::enable_if_t<sizeof...(TailArgs) == sizeof...(Ts)>>
+    Tuple(PiecewiseConstructT, HeadArgs&& headArgs, TailArgs&&... tailArgs)
+    : head(MakeFromTuple<T>(asl::forward<HeadArgs>(headArgs))),
+      tail(PIECEWISE_CONSTRUCT, asl::forward<TailArgs>(tailArgs)...) {}
+};
+
+// 单元素 Tuple 不再携带空的 tail，避免末尾多占 1 字节并引入额外对齐填充
+template <typename T>
+struct Tuple<T> {
+    T head;
+
+    Tuple() : head() {}
+
+    template <typename U,
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<U>, Tuple> &&
+                                          std::is_constructible_v<T, U&&>>>
+    Tuple(U&& h) : head(asl::forward<U>(h)) {}
+
+    template <typename U,
+              typename = std::enable_if_t<!std::is_same_v<T, U> && std::is_constructible_v<T, const U&>>>
+    Tuple(const Tuple<U>& other) : head(other.head) {}
+
+    template <typename U,
+              typename = std::enable_if_t<!std::is_same_v<T, U> && std::is_constructible_v<T, U&&>>>
+    Tuple(Tuple<U>&& other) : head(asl::forward<U>(other.head)) {}
+
+    template <typename HeadArgs>
+    Tuple(PiecewiseConstructT, HeadArgs&& headArgs)
+    : head(MakeFromTuple<T>(asl::forward<HeadArgs>(headArgs))) {}
 };
 
 template <>
@@ -29,7 +89,7 @@ struct Tuple<> {};
 /////////////////////////////////////////////////////////////////////////////////////
 template <typename... Ts>
 Tuple<Ts&&...> ForwardAsTuple(Ts&&... ts) {
-    return Tuple<Ts&&...>(std::forward<Ts>(ts)...);
+    return Tuple<Ts&&...>(asl::forward<Ts>(ts)...);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -68,8 +128,17 @@ struct TupleElemType<N, Tuple<T, Ts...>> {
 
 /////////////////////////////////////////////////////////////////////////////////////
 // 获取特定索引的 Tuple 元素的引用
-template <std::size_t N, typename TupleType>
-typename TupleElemType<N, TupleType>::type& TupleElemGet(TupleType& tuple) {
+template <std::size_t N, typename... Ts>
+typename TupleElemType<N, Tuple<Ts...>>::type& TupleElemGet(Tuple<Ts...>& tuple) {
+    if constexpr (N == 0) {
+        return tuple.head;
+    } else {
+        return TupleElemGet<N - 1>(tuple.tail);
+    }
+}
+
+template <std::size_t N, typename... Ts>
+const typename TupleElemType<N, Tuple<Ts...>>::type& TupleElemGet(const Tuple<Ts...>& tuple) {
     if constexpr (N == 0) {
         return tuple.head;
     } else {
@@ -77,6 +146,77 @@ typename TupleElemType<N, TupleType>::type& TupleElemGet(TupleType& tuple) {
     }
 }
 
+// 右值 Tuple 按元素声明类型转发：值元素返回右值引用，引用元素保持原有引用类别
+template <std::size_t N, typename... Ts>
+typename TupleElemType<N, Tuple<Ts...>>::type&& TupleElemGet(Tuple<Ts...>&& tuple) {
+    using Elem = typename TupleElemType<N, Tuple<Ts...>>::type;
+    return asl::forward<Elem>(TupleElemGet<N>(tuple));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// TupleApply：将 Tuple 的元素展开为函数实参，元素按 Tuple 的值类别转发，不产生拷贝
+template <typename F, typename TupleType, std::size_t... Is>
+decltype(auto) TupleApplyImpl(F&& f, TupleType&& tuple, IndexSequence<Is...>) {
+    return asl::forward<F>(f)(TupleElemGet<Is>(asl::forward<TupleType>(tuple))...);
+}
+
+template <typename F, typename TupleType>
+decltype(auto) TupleApply(F&& f, TupleType&& tuple) {
+    constexpr std::size_t size = TupleSize<std::decay_t<TupleType>>::value;
+    return TupleApplyImpl(asl::forward<F>(f), asl::forward<TupleType>(tuple), MakeIndexSequence<size>{});
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 以元素及其下标调用 f：f 可接受 (elem, index) 或仅接受 (elem)
+// index 以 integral_constant 传入，既可当作 std::size_t 使用，也可用于编译期计算
+template <std::size_t I, typename F, typename Elem>
+decltype(auto) TupleInvokeElem(F& f, Elem&& elem) {
+    if constexpr (std::is_invocable_v<F&, Elem&&, integral_constant<std::size_t, I>>) {
+        return f(asl::forward<Elem>(elem), integral_constant<std::size_t, I>{});
+    } else {
+        return f(asl::forward<Elem>(elem));
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// TupleForEach：按下标顺序对每个元素调用 f
+template <typename TupleType, typename F, std::size_t... Is>
+void TupleForEachImpl(TupleType&& tuple, F& f, IndexSequence<Is...>) {
+    (TupleInvokeElem<Is>(f, TupleElemGet<Is>(asl::forward<TupleType>(tuple))), ...);
+}
+
+template <typename TupleType, typename F>
+void TupleForEach(TupleType&& tuple, F&& f) {
+    constexpr std::size_t size = TupleSize<std::decay_t<TupleType>>::value;
+    TupleForEachImpl(asl::forward<TupleType>(tuple), f, MakeIndexSequence<size>{});
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// TupleTransform：对每个元素调用 f，以返回值组成新的 Tuple（按下标顺序求值）
+template <typename TupleType, typename F, std::size_t... Is>
+auto TupleTransformImpl(TupleType&& tuple, F& f, IndexSequence<Is...>) {
+    using Result = Tuple<std::decay_t<decltype(TupleInvokeElem<Is>(f, TupleElemGet<Is>(asl::forward<TupleType>(tuple))))>...>;
+    return Result{ TupleInvokeElem<Is>(f, TupleElemGet<Is>(asl::forward<TupleType>(tuple)))... };
+}
+
+template <typename TupleType, typename F>
+auto TupleTransform(TupleType&& tuple, F&& f) {
+    constexpr std::size_t size = TupleSize<std::decay_t<TupleType>>::value;
+    return TupleTransformImpl(asl::forward<TupleType>(tuple), f, MakeIndexSequence<size>{});
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename ArgsTuple, std::size_t... Is>
+constexpr T MakeFromTupleImpl(ArgsTuple&& args, IndexSequence<Is...>) {
+    return T(TupleElemGet<Is>(asl::forward<ArgsTuple>(args))...);
+}
+
+template <typename T, typename ArgsTuple>
+constexpr T MakeFromTuple(ArgsTuple&& args) {
+    constexpr std::size_t size = TupleSize<std::decay_t<ArgsTuple>>::value;
+    return MakeFromTupleImpl<T>(asl::forward<ArgsTuple>(args), MakeIndexSequence<size>{});
+}
+
 }
 
 #endif
@@ -6,6 +6,7 @@
 #define TYPELIST_H
 
 #include <cstddef>
+#include <type_traits>
 #include "conditional.h"
 
 namespace asl {
@@ -61,25 +62,42 @@ struct TypeList_Get<TypeList<>, N> {
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
-// ByteOffset 元结构
-template <typename TypeList, std::size_t N>
-struct TypeList_ByteOffset;
+// ByteOffsets 元结构：每个 List 只做一次前缀和，得到全部类型的字节偏移
+// value[N] 为第 N 个类型的偏移，value[Size] 为所有类型的字节总和
+template <typename List>
+struct TypeList_ByteOffsets;
 
-template <std::size_t N>
-struct TypeList_ByteOffset<TypeList<>, N> {
-    static_assert(N < 0, "Index out of range for empty TypeList.");
-    static constexpr std::size_t value = 0;
-};
+template <typename... Ts>
+struct TypeList_ByteOffsets<TypeList<Ts...>> {
+    struct Offsets {
+        std::size_t data[sizeof...(Ts) + 1];
+
+        constexpr std::size_t operator[](std::size_t index) const {
+            return data[index];
+        }
+    };
 
-template <typename Head, typename... Tail>
-struct TypeList_ByteOffset<TypeList<Head, Tail...>, 0> {
-    static constexpr std::size_t value = 0;
+private:
+    static constexpr Offsets Make() {
+        const std::size_t sizes[] = { sizeof(Ts)..., 0 };
+        Offsets offsets{};
+        for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+            offsets.data[i + 1] = offsets.data[i] + sizes[i];
+        }
+        return offsets;
+    }
+
+public:
+    static constexpr Offsets value = Make();
+    static constexpr std::size_t total = value[sizeof...(Ts)];
 };
 
-template <typename Head, typename... Tail, std::size_t N>
-struct TypeList_ByteOffset<TypeList<Head, Tail...>, N> {
-    static_assert(N < sizeof...(Tail) + 1, "Index out of range for TypeList.");
-    static constexpr std::size_t value = sizeof(Head) + TypeList_ByteOffset<TypeList<Tail...>, N - 1>::value;
+/////////////////////////////////////////////////////////////////////////////////////
+// ByteOffset 元结构：查询单个偏移，直接读取 ByteOffsets 的结果而不再递归
+template <typename List, std::size_t N>
+struct TypeList_ByteOffset {
+    static_assert(N < TypeList_Size<List>::value, "Index out of range for TypeList.");
+    static constexpr std::size_t value = TypeList_ByteOffsets<List>::value[N];
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -115,6 +133,196 @@ public:
     >::type;
 };
 
+/////////////////////////////////////////////////////////////////////////////////////
+// Concat 元结构：拼接任意多个 TypeList
+template <typename... Lists>
+struct TypeList_Concat;
+
+template <>
+struct TypeList_Concat<> {
+    using type = TypeList<>;
+};
+
+template <typename... Ts>
+struct TypeList_Concat<TypeList<Ts...>> {
+    using type = TypeList<Ts...>;
+};
+
+template <typename... As, typename... Bs, typename... Rest>
+struct TypeList_Concat<TypeList<As...>, TypeList<Bs...>, Rest...> {
+    using type = typename TypeList_Concat<TypeList<As..., Bs...>, Rest...>::type;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Contains 元结构
+template <typename List, typename T>
+struct TypeList_Contains;
+
+template <typename... Ts, typename T>
+struct TypeList_Contains<TypeList<Ts...>, T> {
+    static constexpr bool value = (std::is_same_v<T, Ts> || ...);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// IndexOf 元结构：T 在 List 中第一次出现的下标
+template <typename List, typename T>
+struct TypeList_IndexOf;
+
+template <typename... Ts, typename T>
+struct TypeList_IndexOf<TypeList<Ts...>, T> {
+private:
+    static constexpr std::size_t Find() {
+        constexpr bool matches[] = { std::is_same_v<T, Ts>..., false };
+        std::size_t index = 0;
+        while (index < sizeof...(Ts) && !matches[index]) {
+            ++index;
+        }
+        return index;
+    }
+
+public:
+    static_assert(TypeList_Contains<TypeList<Ts...>, T>::value, "Type not found in TypeList");
+    static constexpr std::size_t value = Find();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Unique 元结构：去除重复类型，保留每个类型第一次出现的位置
+template <typename List, typename Result = TypeList<>>
+struct TypeList_Unique;
+
+template <typename Result>
+struct TypeList_Unique<TypeList<>, Result> {
+    using type = Result;
+};
+
+template <typename Head, typename... Tail, typename... Rs>
+struct TypeList_Unique<TypeList<Head, Tail...>, TypeList<Rs...>> {
+    using type = typename TypeList_Unique<
+        TypeList<Tail...>,
+        typename Conditional<
+            TypeList_Contains<TypeList<Rs...>, Head>::value,
+            TypeList<Rs...>,
+            TypeList<Rs..., Head>
+        >::type
+    >::type;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Zip 元结构：TypeList<A...>, TypeList<B...> => TypeList<TypeList<A, B>...>
+template <typename List1, typename List2>
+struct TypeList_Zip;
+
+template <typename... As, typename... Bs>
+struct TypeList_Zip<TypeList<As...>, TypeList<Bs...>> {
+    static_assert(sizeof...(As) == sizeof...(Bs), "TypeList_Zip requires lists of the same size");
+    using type = TypeList<TypeList<As, Bs>...>;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Split 元结构：在位置 N 处把 List 拆为 first / second 两段，O(N) 次实例化
+template <typename List, std::size_t N, typename Front = TypeList<>, bool = (N > 0)>
+struct TypeList_Split;
+
+template <typename... Ts, std::size_t N, typename... Fs>
+struct TypeList_Split<TypeList<Ts...>, N, TypeList<Fs...>, false> {
+    using first  = TypeList<Fs...>;
+    using second = TypeList<Ts...>;
+};
+
+template <typename Head, typename... Tail, std::size_t N, typename... Fs>
+struct TypeList_Split<TypeList<Head, Tail...>, N, TypeList<Fs...>, true>
+    : TypeList_Split<TypeList<Tail...>, N - 1, TypeList<Fs..., Head>> {
+};
+
+template <std::size_t N, typename... Fs>
+struct TypeList_Split<TypeList<>, N, TypeList<Fs...>, true> {
+    static_assert(N == 0, "Index out of range in TypeList_Split");
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Merge 元结构：合并两个已排序的 TypeList（稳定：相等时优先取左侧）
+// Compare<A, B>::value 为 true 表示 A 应排在 B 之前
+template <typename Left, typename Right, template <typename, typename> class Compare>
+struct TypeList_Merge;
+
+template <bool TakeRight, typename Left, typename Right, template <typename, typename> class Compare>
+struct TypeList_MergeStep;
+
+template <typename L, typename... Ls, typename R, typename... Rs, template <typename, typename> class Compare>
+struct TypeList_MergeStep<true, TypeList<L, Ls...>, TypeList<R, Rs...>, Compare> {
+    using type = typename TypeList_Prepend<R,
+        typename TypeList_Merge<TypeList<L, Ls...>, TypeList<Rs...>, Compare>::type>::type;
+};
+
+template <typename L, typename... Ls, typename R, typename... Rs, template <typename, typename> class Compare>
+struct TypeList_MergeStep<false, TypeList<L, Ls...>, TypeList<R, Rs...>, Compare> {
+    using type = typename TypeList_Prepend<L,
+        typename TypeList_Merge<TypeList<Ls...>, TypeList<R, Rs...>, Compare>::type>::type;
+};
+
+template <typename... Rs, template <typename, typename> class Compare>
+struct TypeList_Merge<TypeList<>, TypeList<Rs...>, Compare> {
+    using type = TypeList<Rs...>;
+};
+
+template <typename L, typename... Ls, template <typename, typename> class Compare>
+struct TypeList_Merge<TypeList<L, Ls...>, TypeList<>, Compare> {
+    using type = TypeList<L, Ls...>;
+};
+
+template <typename L, typename... Ls, typename R, typename... Rs, template <typename, typename> class Compare>
+struct TypeList_Merge<TypeList<L, Ls...>, TypeList<R, Rs...>, Compare> {
+    using type = typename TypeList_MergeStep<Compare<R, L>::value,
+        TypeList<L, Ls...>, TypeList<R, Rs...>, Compare>::type;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Sort 元结构：稳定的归并排序，共 O(N log N) 次模板实例化
+template <typename List, template <typename, typename> class Compare>
+struct TypeList_Sort;
+
+template <template <typename, typename> class Compare>
+struct TypeList_Sort<TypeList<>, Compare> {
+    using type = TypeList<>;
+};
+
+template <typename T, template <typename, typename> class Compare>
+struct TypeList_Sort<TypeList<T>, Compare> {
+    using type = TypeList<T>;
+};
+
+template <typename T1, typename T2, typename... Ts, template <typename, typename> class Compare>
+struct TypeList_Sort<TypeList<T1, T2, Ts...>, Compare> {
+private:
+    using Halves = TypeList_Split<TypeList<T1, T2, Ts...>, (sizeof...(Ts) + 2) / 2>;
+    using Left   = typename TypeList_Sort<typename Halves::first, Compare>::type;
+    using Right  = typename TypeList_Sort<typename Halves::second, Compare>::type;
+
+public:
+    using type = typename TypeList_Merge<Left, Right, Compare>::type;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 常用比较器
+// 按对齐要求降序
+template <typename A, typename B>
+struct TypeAlignGreater {
+    static constexpr bool value = alignof(A) > alignof(B);
+};
+
+// 按字节大小降序
+template <typename A, typename B>
+struct TypeSizeGreater {
+    static constexpr bool value = sizeof(A) > sizeof(B);
+};
+
+// 先按对齐要求降序，再按字节大小降序：打包到同一块内存时填充最少
+template <typename A, typename B>
+struct TypeLayoutGreater {
+    static constexpr bool value = alignof(A) > alignof(B) ||
+                                  (alignof(A) == alignof(B) && sizeof(A) > sizeof(B));
+};
+
 /////////////////////////////////////////////////////////////////////////////////////
 // Map 元结构
 template <typename List, template <typename> class Mapper>
@@ -0,0 +1,199 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef UNIFIED_BUFFER_H
+#define UNIFIED_BUFFER_H
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "kernel.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 片上 Unified Buffer（UB）的模拟：每个执行线程（即每个核）独占一块固定容量的本地内存
+// 设备上 UB 的大小因型号而异，默认取 192 KiB；可用 UnifiedBuffer::SetCapacity 或环境变量 ASL_UB_SIZE（字节）修改
+constexpr std::size_t UB_DEFAULT_CAPACITY = std::size_t(192) << 10;
+
+// UB 上的分配按 32 字节对齐，与 AscendC 的 DataCopy 对齐要求一致
+constexpr std::size_t UB_ALIGN = 32;
+
+inline std::size_t UbAlignUp(std::size_t bytes) {
+    return (bytes + UB_ALIGN - 1) / UB_ALIGN * UB_ALIGN;
+}
+
+// UB 容量不足：host 上复现设备上会失败的 tiling
+class UbOverflowError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// 位于 UB 上的 Tensor，与 Tensor 一样 size 为字节数
+template<typename T>
+struct LocalTensor {
+    T* data;
+    std::size_t size;
+
+    std::size_t Count() const {
+        return size / sizeof(T);
+    }
+
+    T& operator[](std::size_t index) const {
+        return data[index];
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// UnifiedBuffer：线程私有的栈式分配器
+// 分配只移动栈顶，由 UbScope 整体回退；超出容量时抛出 UbOverflowError
+// 同时统计经 DataCopy 搬入（GM -> UB）与搬出（UB -> GM）的字节数，以及 UB 上的向量运算元素数，供 Simulator 估算
+class UnifiedBuffer {
+public:
+    static void SetCapacity(std::size_t bytes);
+
+    static std::size_t Capacity();
+
+    // 当前线程的 UB；容量在没有任何存活分配时按 Capacity() 重新设置
+    static UnifiedBuffer& Current();
+
+    // 分配 bytes 字节（按 UB_ALIGN 向上取整）
+    void* Allocate(std::size_t bytes);
+
+    template <typename T>
+    LocalTensor<T> AllocTensor(std::size_t count) {
+        return LocalTensor<T>{static_cast<T*>(Allocate(sizeof(T) * count)), sizeof(T) * count};
+    }
+
+    std::size_t Used() const {
+        return used_;
+    }
+
+    // 自上次 ResetStats 以来的最高占用
+    std::size_t Peak() const {
+        return peak_;
+    }
+
+    std::size_t Size() const {
+        return capacity_;
+    }
+
+    std::size_t Mark() const {
+        return used_;
+    }
+
+    void Release(std::size_t mark) {
+        used_ = mark < used_ ? mark : used_;
+    }
+
+    void RecordCopyIn(std::size_t bytes) {
+        copyInBytes_ += bytes;
+    }
+
+    void RecordCopyOut(std::size_t bytes) {
+        copyOutBytes_ += bytes;
+    }
+
+    void RecordVectorOps(std::size_t elements) {
+        vectorOps_ += elements;
+    }
+
+    std::size_t CopyInBytes() const {
+        return copyInBytes_;
+    }
+
+    std::size_t CopyOutBytes() const {
+        return copyOutBytes_;
+    }
+
+    std::size_t VectorOps() const {
+        return vectorOps_;
+    }
+
+    void ResetStats() {
+        peak_ = used_;
+        copyInBytes_ = 0;
+        copyOutBytes_ = 0;
+        vectorOps_ = 0;
+    }
+
+private:
+    void Reserve(std::size_t capacity);
+
+private:
+    std::vector<unsigned char> storage_;
+    unsigned char* base_{nullptr};
+    std::size_t capacity_{0};
+    std::size_t used_{0};
+    std::size_t peak_{0};
+    std::size_t copyInBytes_{0};
+    std::size_t copyOutBytes_{0};
+    std::size_t vectorOps_{0};
+};
+
+// 析构时释放作用域内在当前线程 UB 上的全部分配；执行器为每个 tile 建立一个作用域
+class UbScope {
+public:
+    UbScope() : buffer_(UnifiedBuffer::Current()), mark_(buffer_.Mark()) {}
+
+    ~UbScope() {
+        buffer_.Release(mark_);
+    }
+
+    UbScope(const UbScope&) = delete;
+    UbScope& operator=(const UbScope&) = delete;
+
+private:
+    UnifiedBuffer& buffer_;
+    std::size_t mark_;
+};
+
+template <typename T>
+LocalTensor<T> AllocLocal(std::size_t count) {
+    return UnifiedBuffer::Current().AllocTensor<T>(count);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// DataCopy：在全局内存（kernel 入参的 Tensor）与 UB 之间搬运 count 个元素
+// 越过任一方的边界时抛出 std::out_of_range
+namespace detail {
+    inline void CheckCopy(std::size_t bytes, std::size_t dstSize, std::size_t srcSize) {
+        if (bytes > dstSize || bytes > srcSize) {
+            throw std::out_of_range("DataCopy of " + std::to_string(bytes) + " bytes exceeds tensor size (dst " +
+                                    std::to_string(dstSize) + ", src " + std::to_string(srcSize) + ")");
+        }
+    }
+}
+
+// GM -> UB
+template <typename T>
+void DataCopy(const LocalTensor<T>& dst, const Tensor<T>& src, std::size_t count) {
+    std::size_t bytes = sizeof(T) * count;
+    detail::CheckCopy(bytes, dst.size, src.size);
+    std::memcpy(dst.data, src.data, bytes);
+    UnifiedBuffer::Current().RecordCopyIn(bytes);
+}
+
+// UB -> GM
+template <typename T>
+void DataCopy(const Tensor<T>& dst, const LocalTensor<T>& src, std::size_t count) {
+    std::size_t bytes = sizeof(T) * count;
+    detail::CheckCopy(bytes, dst.size, src.size);
+    std::memcpy(dst.data, src.data, bytes);
+    UnifiedBuffer::Current().RecordCopyOut(bytes);
+}
+
+// UB -> UB，不计入搬运流量
+template <typename T>
+void DataCopy(const LocalTensor<T>& dst, const LocalTensor<T>& src, std::size_t count) {
+    std::size_t bytes = sizeof(T) * count;
+    detail::CheckCopy(bytes, dst.size, src.size);
+    std::memmove(dst.data, src.data, bytes);
+}
+
+}
+
+#endif
@@ -0,0 +1,470 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef VECTOR_OPS_H
+#define VECTOR_OPS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "plan_cache.h"
+#include "unified_buffer.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// AscendC 风格的向量指令在 host 上的实现，操作 UB 上的 LocalTensor
+// 连续写法（Add(dst, src0, src1, count)）对应 AscendC 的 level-2 接口；
+// 带 mask / repeatTimes / RepeatParams 的写法对应 level-0 接口：每次迭代处理 256 字节，由 8 个 32 字节的
+// datablock 组成，blkStride 为同一迭代内相邻 datablock 的间隔、repStride 为相邻迭代起点的间隔（均以 datablock 为单位），
+// mask 为每次迭代参与计算的元素（连续模式为前 mask 个元素，逐位模式为 mask[0] / mask[1] 的置位元素）
+// float 的连续区间按 VectorIsa() 分派到 AVX-512 / AVX2 实现，其他类型为标量循环；
+// 每条指令把处理的元素数记入当前线程 UB 的向量运算统计（见 Simulator）
+constexpr std::size_t VECTOR_REPEAT_BYTES = 256;
+constexpr std::size_t VECTOR_BLOCK_BYTES = 32;
+constexpr std::size_t VECTOR_BLOCKS_PER_REPEAT = VECTOR_REPEAT_BYTES / VECTOR_BLOCK_BYTES;
+
+struct BinaryRepeatParams {
+    std::uint8_t dstBlkStride{1};
+    std::uint8_t src0BlkStride{1};
+    std::uint8_t src1BlkStride{1};
+    std::uint8_t dstRepStride{8};
+    std::uint8_t src0RepStride{8};
+    std::uint8_t src1RepStride{8};
+};
+
+struct UnaryRepeatParams {
+    std::uint8_t dstBlkStride{1};
+    std::uint8_t srcBlkStride{1};
+    std::uint8_t dstRepStride{8};
+    std::uint8_t srcRepStride{8};
+};
+
+enum class VectorBinary {
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MAX,
+    MIN,
+};
+
+enum class VectorScalar {
+    ADDS,
+    MULS,
+    MAXS,
+    MINS,
+};
+
+enum class VectorUnary {
+    EXP,
+    ABS,
+    RELU,
+    SQRT,
+};
+
+// 向量指令当前使用的指令集，默认为 DetectIsa()；SetVectorIsa 用于对比各实现，不会超过 CPU 实际支持的指令集
+IsaVariant VectorIsa();
+void SetVectorIsa(IsaVariant isa);
+
+// float 连续区间的实现
+void VectorBinaryF32(VectorBinary op, float* dst, const float* src0, const float* src1, std::size_t count);
+void VectorScalarF32(VectorScalar op, float* dst, const float* src, float scalar, std::size_t count);
+void VectorUnaryF32(VectorUnary op, float* dst, const float* src, std::size_t count);
+float VectorReduceSumF32(const float* src, std::size_t count);
+float VectorReduceMaxF32(const float* src, std::size_t count);
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace detail {
+    // switch 放在循环外，使每个分支都是可自动向量化的简单循环
+    template <typename T, typename F>
+    void MapLoop(T* dst, const T* src0, const T* src1, std::size_t count, F f) {
+        for (std::size_t i = 0; i < count; ++i) {
+            dst[i] = f(src0[i], src1[i]);
+        }
+    }
+
+    template <typename T, typename F>
+    void MapLoop(T* dst, const T* src, std::size_t count, F f) {
+        for (std::size_t i = 0; i < count; ++i) {
+            dst[i] = f(src[i]);
+        }
+    }
+
+    template <typename T>
+    void BinaryScalarLoop(VectorBinary op, T* dst, const T* src0, const T* src1, std::size_t count) {
+        switch (op) {
+        case VectorBinary::ADD: MapLoop(dst, src0, src1, count, [](T a, T b) { return T(a + b); }); break;
+        case VectorBinary::SUB: MapLoop(dst, src0, src1, count, [](T a, T b) { return T(a - b); }); break;
+        case VectorBinary::MUL: MapLoop(dst, src0, src1, count, [](T a, T b) { return T(a * b); }); break;
+        case VectorBinary::DIV: MapLoop(dst, src0, src1, count, [](T a, T b) { return T(a / b); }); break;
+        case VectorBinary::MAX: MapLoop(dst, src0, src1, count, [](T a, T b) { return a < b ? b : a; }); break;
+        case VectorBinary::MIN: MapLoop(dst, src0, src1, count, [](T a, T b) { return b < a ? b : a; }); break;
+        }
+    }
+
+    template <typename T>
+    void ScalarScalarLoop(VectorScalar op, T* dst, const T* src, T scalar, std::size_t count) {
+        switch (op) {
+        case VectorScalar::ADDS: MapLoop(dst, src, count, [scalar](T a) { return T(a + scalar); }); break;
+        case VectorScalar::MULS: MapLoop(dst, src, count, [scalar](T a) { return T(a * scalar); }); break;
+        case VectorScalar::MAXS: MapLoop(dst, src, count, [scalar](T a) { return a < scalar ? scalar : a; }); break;
+        case VectorScalar::MINS: MapLoop(dst, src, count, [scalar](T a) { return scalar < a ? scalar : a; }); break;
+        }
+    }
+
+    template <typename T>
+    void UnaryScalarLoop(VectorUnary op, T* dst, const T* src, std::size_t count) {
+        switch (op) {
+        case VectorUnary::EXP:  MapLoop(dst, src, count, [](T a) { return static_cast<T>(std::exp(a)); }); break;
+        case VectorUnary::ABS:  MapLoop(dst, src, count, [](T a) { return a < T(0) ? T(-a) : a; }); break;
+        case VectorUnary::RELU: MapLoop(dst, src, count, [](T a) { return a < T(0) ? T(0) : a; }); break;
+        case VectorUnary::SQRT: MapLoop(dst, src, count, [](T a) { return static_cast<T>(std::sqrt(a)); }); break;
+        }
+    }
+
+    template <typename T>
+    void ApplyBinary(VectorBinary op, T* dst, const T* src0, const T* src1, std::size_t count) {
+        if constexpr (std::is_same<T, float>::value) {
+            VectorBinaryF32(op, dst, src0, src1, count);
+        } else {
+            BinaryScalarLoop(op, dst, src0, src1, count);
+        }
+    }
+
+    template <typename T>
+    void ApplyScalar(VectorScalar op, T* dst, const T* src, T scalar, std::size_t count) {
+        if constexpr (std::is_same<T, float>::value) {
+            VectorScalarF32(op, dst, src, scalar, count);
+        } else {
+            ScalarScalarLoop(op, dst, src, scalar, count);
+        }
+    }
+
+    template <typename T>
+    void ApplyUnary(VectorUnary op, T* dst, const T* src, std::size_t count) {
+        if constexpr (std::is_same<T, float>::value) {
+            VectorUnaryF32(op, dst, src, count);
+        } else {
+            UnaryScalarLoop(op, dst, src, count);
+        }
+    }
+
+    inline void CheckCount(std::size_t count, std::size_t available) {
+        if (count > available) {
+            throw std::out_of_range("vector instruction of " + std::to_string(count) +
+                                    " elements exceeds local tensor of " + std::to_string(available));
+        }
+    }
+
+    inline void RecordOps(std::size_t count) {
+        UnifiedBuffer::Current().RecordVectorOps(count);
+    }
+
+    // level-0 的迭代展开：N 个操作数各自的 blkStride / repStride，seg(offsets, n) 处理各操作数从 offsets 起连续的 n 个元素，
+    // lane(offsets) 处理单个元素；mask 为前缀且 blkStride 全为 1 时按段处理，否则逐元素处理
+    template <typename T, std::size_t N>
+    struct RepeatLayout {
+        static_assert(sizeof(T) >= 2, "level-0 vector instructions need 16-bit or wider elements");
+
+        static constexpr std::size_t BLOCK_ELEMS = VECTOR_BLOCK_BYTES / sizeof(T);
+        static constexpr std::size_t REPEAT_ELEMS = VECTOR_REPEAT_BYTES / sizeof(T);
+
+        std::uint64_t mask[2];
+        std::uint8_t repeatTimes;
+        std::uint8_t blkStride[N];
+        std::uint8_t repStride[N];
+
+        bool Enabled(std::size_t lane) const {
+            return (mask[lane / 64] >> (lane % 64)) & 1;
+        }
+
+        // mask 为前缀 [0, n) 时返回 n，否则返回 REPEAT_ELEMS + 1
+        std::size_t PrefixLength() const {
+            std::size_t n = 0;
+            while (n < REPEAT_ELEMS && Enabled(n)) {
+                ++n;
+            }
+            for (std::size_t lane = n; lane < REPEAT_ELEMS; ++lane) {
+                if (Enabled(lane)) {
+                    return REPEAT_ELEMS + 1;
+                }
+            }
+            return n;
+        }
+
+        std::size_t Offset(std::size_t operand, std::size_t repeat, std::size_t lane) const {
+            return (repeat * repStride[operand] + lane / BLOCK_ELEMS * blkStride[operand]) * BLOCK_ELEMS + lane % BLOCK_ELEMS;
+        }
+
+        // 检查每个操作数访问的最大下标，返回参与计算的元素数
+        std::size_t Check(const std::size_t (&available)[N]) const {
+            std::size_t last = 0;
+            std::size_t lanes = 0;
+            for (std::size_t lane = 0; lane < REPEAT_ELEMS; ++lane) {
+                if (Enabled(lane)) {
+                    last = lane;
+                    ++lanes;
+                }
+            }
+            if (lanes == 0 || repeatTimes == 0) {
+                return 0;
+            }
+            for (std::size_t i = 0; i < N; ++i) {
+                std::size_t maxOffset = 0;
+                for (std::size_t lane = 0; lane <= last; ++lane) {
+                    std::size_t offset = Offset(i, repeatTimes - 1, lane);
+                    maxOffset = offset > maxOffset ? offset : maxOffset;
+                }
+                CheckCount(maxOffset + 1, available[i]);
+            }
+            return lanes * repeatTimes;
+        }
+
+        template <typename SEG, typename LANE>
+        void ForEach(SEG&& seg, LANE&& lane) const {
+            bool unitBlocks = true;
+            bool dense = true;
+            for (std::size_t i = 0; i < N; ++i) {
+                unitBlocks = unitBlocks && blkStride[i] == 1;
+                dense = dense && repStride[i] == VECTOR_BLOCKS_PER_REPEAT;
+            }
+            std::size_t prefix = unitBlocks ? PrefixLength() : REPEAT_ELEMS + 1;
+            std::size_t offsets[N];
+            if (prefix == REPEAT_ELEMS && dense) {
+                for (std::size_t i = 0; i < N; ++i) {
+                    offsets[i] = 0;
+                }
+                seg(offsets, REPEAT_ELEMS * repeatTimes);
+                return;
+            }
+            for (std::size_t repeat = 0; repeat < repeatTimes; ++repeat) {
+                if (prefix <= REPEAT_ELEMS) {
+                    for (std::size_t i = 0; i < N; ++i) {
+                        offsets[i] = Offset(i, repeat, 0);
+                    }
+                    seg(offsets, prefix);
+                    continue;
+                }
+                for (std::size_t l = 0; l < REPEAT_ELEMS; ++l) {
+                    if (Enabled(l)) {
+                        for (std::size_t i = 0; i < N; ++i) {
+                            offsets[i] = Offset(i, repeat, l);
+                        }
+                        lane(offsets);
+                    }
+                }
+            }
+        }
+    };
+
+    // 连续模式的 mask：前 mask 个元素
+    template <typename T>
+    void ContinuousMask(std::uint64_t mask, std::uint64_t (&bits)[2]) {
+        constexpr std::size_t REPEAT_ELEMS = VECTOR_REPEAT_BYTES / sizeof(T);
+        if (mask == 0 || mask > REPEAT_ELEMS) {
+            throw std::invalid_argument("continuous mask should be in [1, " + std::to_string(REPEAT_ELEMS) + "]");
+        }
+        bits[0] = mask >= 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << mask) - 1);
+        bits[1] = mask <= 64 ? 0 : (mask >= 128 ? ~std::uint64_t(0) : ((std::uint64_t(1) << (mask - 64)) - 1));
+    }
+
+    template <typename T>
+    void BinaryRepeat(VectorBinary op, const LocalTensor<T>& dst, const LocalTensor<T>& src0, const LocalTensor<T>& src1,
+                      const std::uint64_t (&mask)[2], std::uint8_t repeatTimes, const BinaryRepeatParams& params) {
+        RepeatLayout<T, 3> layout{{mask[0], mask[1]}, repeatTimes,
+                                  {params.dstBlkStride, params.src0BlkStride, params.src1BlkStride},
+                                  {params.dstRepStride, params.src0RepStride, params.src1RepStride}};
+        RecordOps(layout.Check({dst.Count(), src0.Count(), src1.Count()}));
+        layout.ForEach([&](const std::size_t* offsets, std::size_t n) {
+            ApplyBinary(op, dst.data + offsets[0], src0.data + offsets[1], src1.data + offsets[2], n);
+        }, [&](const std::size_t* offsets) {
+            BinaryScalarLoop(op, dst.data + offsets[0], src0.data + offsets[1], src1.data + offsets[2], 1);
+        });
+    }
+
+    template <typename T>
+    void ScalarRepeat(VectorScalar op, const LocalTensor<T>& dst, const LocalTensor<T>& src, T scalar,
+                      const std::uint64_t (&mask)[2], std::uint8_t repeatTimes, const UnaryRepeatParams& params) {
+        RepeatLayout<T, 2> layout{{mask[0], mask[1]}, repeatTimes,
+                                  {params.dstBlkStride, params.srcBlkStride},
+                                  {params.dstRepStride, params.srcRepStride}};
+        RecordOps(layout.Check({dst.Count(), src.Count()}));
+        layout.ForEach([&](const std::size_t* offsets, std::size_t n) {
+            ApplyScalar(op, dst.data + offsets[0], src.data + offsets[1], scalar, n);
+        }, [&](const std::size_t* offsets) {
+            ScalarScalarLoop(op, dst.data + offsets[0], src.data + offsets[1], scalar, 1);
+        });
+    }
+
+    template <typename T>
+    void UnaryRepeat(VectorUnary op, const LocalTensor<T>& dst, const LocalTensor<T>& src,
+                     const std::uint64_t (&mask)[2], std::uint8_t repeatTimes, const UnaryRepeatParams& params) {
+        RepeatLayout<T, 2> layout{{mask[0], mask[1]}, repeatTimes,
+                                  {params.dstBlkStride, params.srcBlkStride},
+                                  {params.dstRepStride, params.srcRepStride}};
+        RecordOps(layout.Check({dst.Count(), src.Count()}));
+        layout.ForEach([&](const std::size_t* offsets, std::size_t n) {
+            ApplyUnary(op, dst.data + offsets[0], src.data + offsets[1], n);
+        }, [&](const std::size_t* offsets) {
+            UnaryScalarLoop(op, dst.data + offsets[0], src.data + offsets[1], 1);
+        });
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 二元指令：dst = src0 op src1
+#define ASL_DEFINE_VECTOR_BINARY(NAME, OP)                                                                  \
+template <typename T>                                                                                       \
+void NAME(const LocalTensor<T>& dst, const LocalTensor<T>& src0, const LocalTensor<T>& src1,                \
+          std::size_t count) {                                                                              \
+    detail::CheckCount(count, dst.Count());                                                                 \
+    detail::CheckCount(count, src0.Count());                                                                \
+    detail::CheckCount(count, src1.Count());                                                                \
+    detail::ApplyBinary(VectorBinary::OP, dst.data, src0.data, src1.data, count);                           \
+    detail::RecordOps(count);                                                                               \
+}                                                                                                           \
+                                                                                                            \
+template <typename T>                                                                                       \
+void NAME(const LocalTensor<T>& dst, const LocalTensor<T>& src0, const LocalTensor<T>& src1,                \
+          std::uint64_t mask, std::uint8_t repeatTimes, const BinaryRepeatParams& params) {                 \
+    std::uint64_t bits[2];                                                                                  \
+    detail::ContinuousMask<T>(mask, bits);                                                                  \
+    detail::BinaryRepeat(VectorBinary::OP, dst, src0, src1, bits, repeatTimes, params);                     \
+}                                                                                                           \
+                                                                                                            \
+template <typename T>                                                                                       \
+void NAME(const LocalTensor<T>& dst, const LocalTensor<T>& src0, const LocalTensor<T>& src1,                \
+          const std::uint64_t (&mask)[2], std::uint8_t repeatTimes, const BinaryRepeatParams& params) {     \
+    detail::BinaryRepeat(VectorBinary::OP, dst, src0, src1, mask, repeatTimes, params);                     \
+}
+
+ASL_DEFINE_VECTOR_BINARY(Add, ADD)
+ASL_DEFINE_VECTOR_BINARY(Sub, SUB)
+ASL_DEFINE_VECTOR_BINARY(Mul, MUL)
+ASL_DEFINE_VECTOR_BINARY(Div, DIV)
+ASL_DEFINE_VECTOR_BINARY(Max, MAX)
+ASL_DEFINE_VECTOR_BINARY(Min, MIN)
+
+#undef ASL_DEFINE_VECTOR_BINARY
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 标量指令：dst = src op scalar
+#define ASL_DEFINE_VECTOR_SCALAR(NAME, OP)                                                                  \
+template <typename T>                                                                                       \
+void NAME(const LocalTensor<T>& dst, const LocalTensor<T>& src, T scalar, std::size_t count) {              \
+    detail::CheckCount(count, dst.Count());                                                                 \
+    detail::CheckCount(count, src.Count());                                                                 \
+    detail::ApplyScalar(VectorScalar::OP, dst.data, src.data, scalar, count);                               \
+    detail::RecordOps(count);                                                                               \
+}                                                                                                           \
+                                                                                                            \
+template <typename T>                                                                                       \
+void NAME(const LocalTensor<T>& dst, const LocalTensor<T>& src, T scalar,                                   \
+          std::uint64_t mask, std::uint8_t repeatTimes, const UnaryRepeatParams& params) {                  \
+    std::uint64_t bits[2];                                                                                  \
+    detail::ContinuousMask<T>(mask, bits);                                                                  \
+    detail::ScalarRepeat(VectorScalar::OP, dst, src, scalar, bits, repeatTimes, params);                    \
+}                                                                                                           \
+                                                                                                            \
+template <typename T>                                                                                       \
+void NAME(const LocalTensor<T>& dst, const LocalTensor<T>& src, T scalar,                                   \
+          const std::uint64_t (&mask)[2], std::uint8_t repeatTimes, const UnaryRepeatParams& params) {      \
+    detail::ScalarRepeat(VectorScalar::OP, dst, src, scalar, mask, repeatTimes, params);                    \
+}
+
+ASL_DEFINE_VECTOR_SCALAR(Adds, ADDS)
+ASL_DEFINE_VECTOR_SCALAR(Muls, MULS)
+ASL_DEFINE_VECTOR_SCALAR(Maxs, MAXS)
+ASL_DEFINE_VECTOR_SCALAR(Mins, MINS)
+
+#undef ASL_DEFINE_VECTOR_SCALAR
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 一元指令：dst = op(src)
+#define ASL_DEFINE_VECTOR_UNARY(NAME, OP)                                                                   \
+template <typename T>                                                                                       \
+void NAME(const LocalTensor<T>& dst, const LocalTensor<T>& src, std::size_t count) {                        \
+    detail::CheckCount(count, dst.Count());                                                                 \
+    detail::CheckCount(count, src.Count());                                                                 \
+    detail::ApplyUnary(VectorUnary::OP, dst.data, src.data, count);                                         \
+    detail::RecordOps(count);                                                                               \
+}                                                                                                           \
+                                                                                                            \
+template <typename T>                                                                                       \
+void NAME(const LocalTensor<T>& dst, const LocalTensor<T>& src,                                             \
+          std::uint64_t mask, std::uint8_t repeatTimes, const UnaryRepeatParams& params) {                  \
+    std::uint64_t bits[2];                                                                                  \
+    detail::ContinuousMask<T>(mask, bits);                                                                  \
+    detail::UnaryRepeat(VectorUnary::OP, dst, src, bits, repeatTimes, params);                              \
+}                                                                                                           \
+                                                                                                            \
+template <typename T>                                                                                       \
+void NAME(const LocalTensor<T>& dst, const LocalTensor<T>& src,                                             \
+          const std::uint64_t (&mask)[2], std::uint8_t repeatTimes, const UnaryRepeatParams& params) {      \
+    detail::UnaryRepeat(VectorUnary::OP, dst, src, mask, repeatTimes, params);                              \
+}
+
+ASL_DEFINE_VECTOR_UNARY(Exp, EXP)
+ASL_DEFINE_VECTOR_UNARY(Abs, ABS)
+ASL_DEFINE_VECTOR_UNARY(Relu, RELU)
+ASL_DEFINE_VECTOR_UNARY(Sqrt, SQRT)
+
+#undef ASL_DEFINE_VECTOR_UNARY
+
+/////////////////////////////////////////////////////////////////////////////////////
+// dst 的前 count 个元素置为 scalar
+template <typename T>
+void Duplicate(const LocalTensor<T>& dst, T scalar, std::size_t count) {
+    detail::CheckCount(count, dst.Count());
+    for (std::size_t i = 0; i < count; ++i) {
+        dst.data[i] = scalar;
+    }
+    detail::RecordOps(count);
+}
+
+// 归约指令：dst[0] = reduce(src[0, count))；workLocal 对应设备上的中间结果缓冲，host 上不使用
+template <typename T>
+void ReduceSum(const LocalTensor<T>& dst, const LocalTensor<T>& src, const LocalTensor<T>& workLocal, std::size_t count) {
+    (void)workLocal;
+    detail::CheckCount(1, dst.Count());
+    detail::CheckCount(count, src.Count());
+    if constexpr (std::is_same<T, float>::value) {
+        dst.data[0] = VectorReduceSumF32(src.data, count);
+    } else {
+        T sum = T(0);
+        for (std::size_t i = 0; i < count; ++i) {
+            sum += src.data[i];
+        }
+        dst.data[0] = sum;
+    }
+    detail::RecordOps(count);
+}
+
+template <typename T>
+void ReduceMax(const LocalTensor<T>& dst, const LocalTensor<T>& src, const LocalTensor<T>& workLocal, std::size_t count) {
+    (void)workLocal;
+    detail::CheckCount(1, dst.Count());
+    detail::CheckCount(count, src.Count());
+    if (count == 0) {
+        throw std::invalid_argument("ReduceMax of an empty tensor");
+    }
+    if constexpr (std::is_same<T, float>::value) {
+        dst.data[0] = VectorReduceMaxF32(src.data, count);
+    } else {
+        T best = src.data[0];
+        for (std::size_t i = 1; i < count; ++i) {
+            best = best < src.data[i] ? src.data[i] : best;
+        }
+        dst.data[0] = best;
+    }
+    detail::RecordOps(count);
+}
+
+}
+
+#endif
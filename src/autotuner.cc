@@ -0,0 +1,136 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "autotuner.h"
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include "kernel_ops.h"
+#include "unified_buffer.h"
+
+namespace asl {
+
+std::size_t Autotuner::CountBucket(std::size_t count) {
+    std::size_t bucket = 0;
+    while (count > 1) {
+        count >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+bool Autotuner::Find(std::string_view signature, std::size_t count, TunedConfig& config) const {
+    ExecutionPlan plan;
+    if (!cache_.Find(signature, static_cast<std::uint32_t>(CountBucket(count)), isa_, plan)) {
+        return false;
+    }
+    config = TunedConfig{plan.blockDim, static_cast<std::size_t>(plan.tileSize), plan.seconds};
+    return true;
+}
+
+void Autotuner::Set(std::string_view signature, std::size_t bucket, const TunedConfig& config, const PlanLayout& layout) {
+    ExecutionPlan plan{PlanSignatureHash(signature), static_cast<std::uint32_t>(bucket), isa_,
+                       static_cast<std::uint32_t>(config.blockDim), 0, config.tileSize, config.seconds, layout};
+    cache_.Insert(plan);
+}
+
+std::size_t Autotuner::Size() const {
+    return cache_.Size();
+}
+
+void Autotuner::Clear() {
+    cache_.Clear();
+}
+
+LaunchConfig Autotuner::Resolve(std::string_view signature, std::size_t count, const LaunchConfig& config) const {
+    if (config.pool == nullptr || config.blockDim != AUTO_BLOCK_DIM) {
+        return config;
+    }
+    LaunchConfig resolved = config;
+    TunedConfig tuned;
+    if (Find(signature, count, tuned)) {
+        resolved.blockDim = tuned.blockDim;
+        resolved.tileSize = tuned.tileSize;
+    } else {
+        resolved.blockDim = config.pool->Size();
+    }
+    return resolved;
+}
+
+TunedConfig Autotuner::Tune(std::string_view signature, ThreadPool& pool, std::size_t count,
+                            const std::function<void(const LaunchConfig&)>& launch,
+                            const TuneCandidates& candidates, const PlanLayout& layout) {
+    std::vector<std::size_t> blockDims = candidates.blockDims;
+    if (blockDims.empty()) {
+        for (std::size_t dim = 1; dim < pool.Size(); dim *= 2) {
+            blockDims.push_back(dim);
+        }
+        blockDims.push_back(pool.Size());
+        blockDims.push_back(pool.Size() * 2);
+    }
+    std::vector<std::size_t> tileSizes = candidates.tileSizes.empty() ? std::vector<std::size_t>{0} : candidates.tileSizes;
+
+    TunedConfig best;
+    bool found = false;
+    for (std::size_t blockDim : blockDims) {
+        for (std::size_t tileSize : tileSizes) {
+            LaunchConfig config{&pool, std::max<std::size_t>(blockDim, 1), LaunchSchedule::STATIC, tileSize};
+            // 预热一次，排除首次访问缺页的影响；临时 Tensor 放不进 UB 的组合在设备上同样无法运行，直接跳过
+            try {
+                launch(config);
+            } catch (const UbOverflowError&) {
+                continue;
+            }
+            double seconds = 0.0;
+            for (std::size_t i = 0; i < std::max<std::size_t>(candidates.repeat, 1); ++i) {
+                std::uint64_t start = Profiler::NowNs();
+                launch(config);
+                double elapsed = (Profiler::NowNs() - start) * 1e-9;
+                seconds = (i == 0 || elapsed < seconds) ? elapsed : seconds;
+            }
+            if (!found || seconds < best.seconds) {
+                best = TunedConfig{config.blockDim, tileSize, seconds};
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        throw UbOverflowError(std::string(signature) + ": no tuning candidate fits in the unified buffer");
+    }
+    Set(signature, CountBucket(count), best, layout);
+    return best;
+}
+
+bool Autotuner::Save(const std::string& path) const {
+    return cache_.Save(path);
+}
+
+bool Autotuner::Load(const std::string& path) {
+    return cache_.Open(path);
+}
+
+Autotuner& Autotuner::Default() {
+    static std::unique_ptr<Autotuner> tuner = []() {
+        auto tuner = std::make_unique<Autotuner>();
+        if (const char* path = std::getenv("ASL_PLAN_CACHE")) {
+            tuner->Load(path);
+        }
+        return tuner;
+    }();
+    return *tuner;
+}
+
+void TunePrebuiltKernels(Autotuner& tuner, ThreadPool& pool, const std::vector<std::size_t>& counts,
+                         const TuneCandidates& candidates) {
+    for (std::size_t count : counts) {
+#define ASL_TUNE_PREBUILT_ELEM_WISE(OP, T) \
+        tuner.Tune<BinaryElemWise<OP, T>>(pool, count, candidates);
+
+        ASL_FOR_EACH_PREBUILT_ELEM_WISE(ASL_TUNE_PREBUILT_ELEM_WISE)
+
+#undef ASL_TUNE_PREBUILT_ELEM_WISE
+    }
+}
+
+}
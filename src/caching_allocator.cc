@@ -0,0 +1,316 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "caching_allocator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace asl {
+
+namespace {
+    constexpr std::size_t NO_BUCKET = std::numeric_limits<std::size_t>::max();
+    constexpr std::size_t MIN_BUCKET_SIZE = CachingAllocator::ALIGNMENT;
+    constexpr std::size_t MAX_BUCKET_SIZE = std::size_t(1) << 40;
+
+    // 位于每个块之前的头部，占用一个对齐单元，保证返回地址仍然 64 字节对齐
+    struct alignas(CachingAllocator::ALIGNMENT) BlockHeader {
+        std::size_t bucket;
+        std::size_t bytes;
+        std::size_t requested;
+        BlockHeader* next;
+    };
+
+    static_assert(sizeof(BlockHeader) == CachingAllocator::ALIGNMENT, "BlockHeader should occupy one alignment unit");
+
+    std::size_t RoundUp(std::size_t bytes, std::size_t align) {
+        return (bytes + align - 1) / align * align;
+    }
+
+    BlockHeader* HeaderOf(Addr addr) {
+        return reinterpret_cast<BlockHeader*>(addr) - 1;
+    }
+
+    Addr AddrOf(BlockHeader* header) {
+        return reinterpret_cast<Addr>(header + 1);
+    }
+
+    BlockHeader* SystemAllocate(std::size_t bytes) {
+        void* mem = std::aligned_alloc(CachingAllocator::ALIGNMENT, sizeof(BlockHeader) + bytes);
+        if (mem == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<BlockHeader*>(mem);
+    }
+
+    // 单个桶的空闲链表
+    struct FreeList {
+        BlockHeader* head{nullptr};
+        std::size_t count{0};
+
+        void Push(BlockHeader* block) {
+            block->next = head;
+            head = block;
+            ++count;
+        }
+
+        BlockHeader* Pop() {
+            BlockHeader* block = head;
+            if (block != nullptr) {
+                head = block->next;
+                --count;
+            }
+            return block;
+        }
+    };
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 分配器与各线程缓存共享的状态：线程缓存持有 shared_ptr，
+// 因此分配器销毁后，线程退出时仍可安全地归还其缓存的块
+struct CachingAllocator::Shared {
+    explicit Shared(const CachingAllocatorConfig& config) : config(config) {
+        std::size_t size = MIN_BUCKET_SIZE;
+        while (size <= MAX_BUCKET_SIZE) {
+            bucketSizes.push_back(size);
+            std::size_t next = config.policy == BucketPolicy::POWER_OF_TWO
+                             ? size * 2
+                             : RoundUp(size + size / 4, MIN_BUCKET_SIZE);
+            size = std::max(next, size + MIN_BUCKET_SIZE);
+        }
+        globalLists.resize(bucketSizes.size());
+    }
+
+    ~Shared() {
+        ReleaseGlobal();
+    }
+
+    std::size_t BucketOf(std::size_t bytes) const {
+        auto it = std::lower_bound(bucketSizes.begin(), bucketSizes.end(), std::max<std::size_t>(bytes, 1));
+        return it == bucketSizes.end() ? NO_BUCKET : static_cast<std::size_t>(it - bucketSizes.begin());
+    }
+
+    BlockHeader* PopGlobal(std::size_t bucket) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return globalLists[bucket].Pop();
+    }
+
+    // 在缓存上限内为 bytes 字节记账；线程缓存与全局缓存共用同一个上限
+    bool ReserveCached(std::size_t bytes) {
+        std::size_t cached = bytesCached.load();
+        do {
+            if (cached + bytes > config.maxCachedBytes) {
+                return false;
+            }
+        } while (!bytesCached.compare_exchange_weak(cached, cached + bytes));
+        return true;
+    }
+
+    // 放回全局缓存；超出缓存上限或分配器已销毁时直接归还系统
+    void PushGlobal(BlockHeader* block) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!destroyed && ReserveCached(block->bytes)) {
+                globalLists[block->bucket].Push(block);
+                return;
+            }
+        }
+        std::free(block);
+    }
+
+    void ReleaseGlobal() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& list : globalLists) {
+            while (BlockHeader* block = list.Pop()) {
+                bytesCached -= block->bytes;
+                std::free(block);
+            }
+        }
+    }
+
+    const CachingAllocatorConfig config;
+    std::vector<std::size_t> bucketSizes;
+
+    std::mutex mutex;
+    std::vector<FreeList> globalLists;
+    bool destroyed{false};
+
+    // 每次 ReleaseCached 或分配器销毁时递增；其他线程下次访问分配器时发现代数变化，便把自己缓存的块归还系统
+    std::atomic<std::uint64_t> generation{0};
+
+    std::atomic<std::size_t> hits{0};
+    std::atomic<std::size_t> misses{0};
+    std::atomic<std::size_t> bytesCached{0};
+    std::atomic<std::size_t> bytesInUse{0};
+    std::atomic<std::size_t> bytesRequested{0};
+};
+
+namespace {
+    using Shared = CachingAllocator::Shared;
+
+    // 单个线程对单个分配器的缓存
+    struct ThreadCache {
+        explicit ThreadCache(std::shared_ptr<Shared> shared)
+        : shared(std::move(shared)), lists(this->shared->bucketSizes.size()),
+          generation(this->shared->generation.load()) {
+        }
+
+        ~ThreadCache() {
+            Flush();
+        }
+
+        // 放回全局缓存
+        void Flush() {
+            for (auto& list : lists) {
+                while (BlockHeader* block = list.Pop()) {
+                    shared->bytesCached -= block->bytes;
+                    shared->PushGlobal(block);
+                }
+            }
+        }
+
+        // 直接归还系统
+        void Release() {
+            for (auto& list : lists) {
+                while (BlockHeader* block = list.Pop()) {
+                    shared->bytesCached -= block->bytes;
+                    std::free(block);
+                }
+            }
+        }
+
+        std::shared_ptr<Shared> shared;
+        std::vector<FreeList> lists;
+        std::uint64_t generation;
+    };
+
+    struct ThreadCaches {
+        ThreadCache& Get(const std::shared_ptr<Shared>& shared) {
+            for (auto& cache : caches) {
+                if (cache->shared == shared) {
+                    std::uint64_t generation = shared->generation.load();
+                    if (cache->generation != generation) {
+                        cache->Release();
+                        cache->generation = generation;
+                    }
+                    return *cache;
+                }
+            }
+            // 顺便清理已销毁分配器的缓存，避免线程长期持有其内存
+            caches.erase(std::remove_if(caches.begin(), caches.end(), [](const std::unique_ptr<ThreadCache>& cache) {
+                std::lock_guard<std::mutex> lock(cache->shared->mutex);
+                return cache->shared->destroyed;
+            }), caches.end());
+            caches.push_back(std::make_unique<ThreadCache>(shared));
+            return *caches.back();
+        }
+
+        std::vector<std::unique_ptr<ThreadCache>> caches;
+    };
+
+    thread_local ThreadCaches threadCaches;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+CachingAllocator::CachingAllocator(const CachingAllocatorConfig& config)
+: shared_(std::make_shared<Shared>(config)) {
+}
+
+CachingAllocator::~CachingAllocator() {
+    {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        shared_->destroyed = true;
+    }
+    ++shared_->generation;
+    for (auto& cache : threadCaches.caches) {
+        if (cache->shared == shared_) {
+            cache->Flush();
+        }
+    }
+    shared_->ReleaseGlobal();
+}
+
+CachingAllocator& CachingAllocator::Default() {
+    static CachingAllocator allocator;
+    return allocator;
+}
+
+std::size_t CachingAllocator::BucketSize(std::size_t bytes) const {
+    std::size_t bucket = shared_->BucketOf(bytes);
+    return bucket == NO_BUCKET ? 0 : shared_->bucketSizes[bucket];
+}
+
+Addr CachingAllocator::Allocate(std::size_t bytes) {
+    std::size_t bucket = shared_->BucketOf(bytes);
+    BlockHeader* block = nullptr;
+
+    if (bucket == NO_BUCKET) {
+        block = SystemAllocate(RoundUp(bytes, ALIGNMENT));
+        block->bytes = RoundUp(bytes, ALIGNMENT);
+        ++shared_->misses;
+    } else {
+        block = threadCaches.Get(shared_).lists[bucket].Pop();
+        if (block == nullptr) {
+            block = shared_->PopGlobal(bucket);
+        }
+        if (block != nullptr) {
+            shared_->bytesCached -= block->bytes;
+            ++shared_->hits;
+        } else {
+            block = SystemAllocate(shared_->bucketSizes[bucket]);
+            block->bytes = shared_->bucketSizes[bucket];
+            ++shared_->misses;
+        }
+    }
+
+    block->bucket = bucket;
+    block->requested = bytes;
+    shared_->bytesInUse += block->bytes;
+    shared_->bytesRequested += bytes;
+    return AddrOf(block);
+}
+
+void CachingAllocator::Free(Addr addr) {
+    if (addr == nullptr) {
+        return;
+    }
+    BlockHeader* block = HeaderOf(addr);
+    shared_->bytesInUse -= block->bytes;
+    shared_->bytesRequested -= block->requested;
+
+    if (block->bucket == NO_BUCKET) {
+        std::free(block);
+        return;
+    }
+
+    FreeList& list = threadCaches.Get(shared_).lists[block->bucket];
+    if (list.count < shared_->config.threadCacheBlocks && shared_->ReserveCached(block->bytes)) {
+        list.Push(block);
+    } else {
+        shared_->PushGlobal(block);
+    }
+}
+
+void CachingAllocator::ReleaseCached() {
+    ++shared_->generation;
+    threadCaches.Get(shared_).Release();
+    shared_->ReleaseGlobal();
+}
+
+AllocatorStats CachingAllocator::Stats() const {
+    AllocatorStats stats;
+    stats.hits = shared_->hits.load();
+    stats.misses = shared_->misses.load();
+    stats.bytesCached = shared_->bytesCached.load();
+    stats.bytesInUse = shared_->bytesInUse.load();
+    stats.bytesRequested = shared_->bytesRequested.load();
+    return stats;
+}
+
+}
@@ -0,0 +1,103 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "huge_page.h"
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace asl {
+
+namespace {
+    std::size_t RoundUpToHugePage(std::size_t bytes) {
+        return (std::max<std::size_t>(bytes, 1) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    void* MapAnonymous(std::size_t bytes, int extraFlags) {
+        void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+        return addr == MAP_FAILED ? nullptr : addr;
+    }
+
+    // 多映射一个大页，再裁掉首尾使起点按 2 MiB 对齐，保证透明大页可以整页映射
+    void* MapAligned(std::size_t bytes) {
+        std::size_t mapped = bytes + HUGE_PAGE_SIZE;
+        auto* raw = static_cast<unsigned char*>(MapAnonymous(mapped, MAP_NORESERVE));
+        if (raw == nullptr) {
+            return nullptr;
+        }
+        auto begin = reinterpret_cast<std::uintptr_t>(raw);
+        auto aligned = (begin + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        std::size_t head = aligned - begin;
+        std::size_t tail = mapped - head - bytes;
+        if (head > 0) {
+            munmap(raw, head);
+        }
+        if (tail > 0) {
+            munmap(raw + head + bytes, tail);
+        }
+        return raw + head;
+    }
+}
+
+HugePageBuffer::HugePageBuffer(std::size_t bytes, HugePagePolicy policy) {
+    bytes_ = RoundUpToHugePage(bytes);
+
+#ifdef MAP_HUGETLB
+    if (policy != HugePagePolicy::TRANSPARENT) {
+        void* addr = MapAnonymous(bytes_, MAP_HUGETLB);
+        if (addr != nullptr) {
+            addr_ = static_cast<Addr>(addr);
+            mode_ = HugePageMode::EXPLICIT;
+            return;
+        }
+    }
+#endif
+    if (policy == HugePagePolicy::EXPLICIT) {
+        throw std::runtime_error("explicit huge pages are not available, check /proc/sys/vm/nr_hugepages");
+    }
+
+    void* addr = MapAligned(bytes_);
+    if (addr == nullptr) {
+        throw std::bad_alloc();
+    }
+    addr_ = static_cast<Addr>(addr);
+    mode_ = HugePageMode::NORMAL;
+#ifdef MADV_HUGEPAGE
+    if (madvise(addr, bytes_, MADV_HUGEPAGE) == 0) {
+        mode_ = HugePageMode::TRANSPARENT;
+    }
+#endif
+}
+
+HugePageBuffer::~HugePageBuffer() {
+    Release();
+}
+
+HugePageBuffer::HugePageBuffer(HugePageBuffer&& other) noexcept
+: addr_(std::exchange(other.addr_, nullptr)),
+  bytes_(std::exchange(other.bytes_, 0)),
+  mode_(other.mode_) {
+}
+
+HugePageBuffer& HugePageBuffer::operator=(HugePageBuffer&& other) noexcept {
+    if (this != &other) {
+        Release();
+        addr_ = std::exchange(other.addr_, nullptr);
+        bytes_ = std::exchange(other.bytes_, 0);
+        mode_ = other.mode_;
+    }
+    return *this;
+}
+
+void HugePageBuffer::Release() {
+    if (addr_ != nullptr) {
+        munmap(addr_, bytes_);
+        addr_ = nullptr;
+    }
+}
+
+}
@@ -0,0 +1,15 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "kernel_ops.h"
+
+namespace asl {
+
+#define ASL_DEFINE_PREBUILT_ELEM_WISE(OP, T) template class ElemWise<OP, Input<T, T>, Output<T>>;
+
+ASL_FOR_EACH_PREBUILT_ELEM_WISE(ASL_DEFINE_PREBUILT_ELEM_WISE)
+
+#undef ASL_DEFINE_PREBUILT_ELEM_WISE
+
+}
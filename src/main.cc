@@ -1,6 +1,59 @@
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <vector>
+#include "autotuner.h"
+#include "roofline.h"
+#include "simulator.h"
 
-int main() {
+namespace {
+  // easy_cann_service roofline [count]：测量机器峰值并输出预置 kernel 的 roofline 报告
+  int RunRoofline(int argc, char** argv) {
+    std::size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : (std::size_t(1) << 24);
+    asl::ThreadPool& pool = asl::ThreadPool::Default();
+    asl::RooflineReport report(asl::MeasureMachinePeak(pool));
+    asl::MeasurePrebuiltKernels(report, pool, count);
+    std::cout << report.Format();
+    return 0;
+  }
+
+  // easy_cann_service autotune <file> [count...]：为预置 kernel 调优并保存，运行时通过 ASL_PLAN_CACHE 映射
+  int RunAutotune(int argc, char** argv) {
+    if (argc < 3) {
+      std::cerr << "usage: " << argv[0] << " autotune <file> [count...]" << std::endl;
+      return 1;
+    }
+    std::vector<std::size_t> counts;
+    for (int i = 3; i < argc; ++i) {
+      counts.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (counts.empty()) {
+      counts = {std::size_t(1) << 16, std::size_t(1) << 20, std::size_t(1) << 24};
+    }
+    asl::Autotuner& tuner = asl::Autotuner::Default();
+    asl::TunePrebuiltKernels(tuner, asl::ThreadPool::Default(), counts);
+    return tuner.Save(argv[2]) ? 0 : 1;
+  }
+
+  // easy_cann_service simulate [count]：在不同 tileSize 下执行预置 kernel，并列输出实测耗时与机器模型的估算耗时
+  int RunSimulate(int argc, char** argv) {
+    std::size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : (std::size_t(1) << 22);
+    asl::SimulatePrebuiltKernels(asl::ThreadPool::Default(), count, {0, 4096, 16384, 65536});
+    std::cout << asl::Simulator::Report();
+    return 0;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && std::strcmp(argv[1], "roofline") == 0) {
+    return RunRoofline(argc, argv);
+  }
+  if (argc > 1 && std::strcmp(argv[1], "autotune") == 0) {
+    return RunAutotune(argc, argv);
+  }
+  if (argc > 1 && std::strcmp(argv[1], "simulate") == 0) {
+    return RunSimulate(argc, argv);
+  }
   std::cout << "OK!" << std::endl;
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,82 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "matmul.h"
+#include "vector_ops.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ASL_MATMUL_X86 1
+#endif
+
+namespace asl {
+
+namespace {
+#ifdef ASL_MATMUL_X86
+    // 6 x 16：12 个 ymm 累加器，每步 2 次 B 加载、6 次 A 广播、12 次 FMA
+    __attribute__((target("avx2,fma")))
+    void GemmKernelAvx2(std::size_t kc, const float* packedA, const float* packedB, float* c, std::size_t ldc) {
+        __m256 acc[6][2];
+        for (std::size_t i = 0; i < 6; ++i) {
+            acc[i][0] = _mm256_setzero_ps();
+            acc[i][1] = _mm256_setzero_ps();
+        }
+        for (std::size_t p = 0; p < kc; ++p) {
+            __m256 b0 = _mm256_loadu_ps(packedB + p * 16);
+            __m256 b1 = _mm256_loadu_ps(packedB + p * 16 + 8);
+            for (std::size_t i = 0; i < 6; ++i) {
+                __m256 a = _mm256_broadcast_ss(packedA + p * 6 + i);
+                acc[i][0] = _mm256_fmadd_ps(a, b0, acc[i][0]);
+                acc[i][1] = _mm256_fmadd_ps(a, b1, acc[i][1]);
+            }
+        }
+        for (std::size_t i = 0; i < 6; ++i) {
+            float* row = c + i * ldc;
+            _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), acc[i][0]));
+            _mm256_storeu_ps(row + 8, _mm256_add_ps(_mm256_loadu_ps(row + 8), acc[i][1]));
+        }
+    }
+
+    // 8 x 32：16 个 zmm 累加器
+    __attribute__((target("avx512f")))
+    void GemmKernelAvx512(std::size_t kc, const float* packedA, const float* packedB, float* c, std::size_t ldc) {
+        __m512 acc[8][2];
+        for (std::size_t i = 0; i < 8; ++i) {
+            acc[i][0] = _mm512_setzero_ps();
+            acc[i][1] = _mm512_setzero_ps();
+        }
+        for (std::size_t p = 0; p < kc; ++p) {
+            __m512 b0 = _mm512_loadu_ps(packedB + p * 32);
+            __m512 b1 = _mm512_loadu_ps(packedB + p * 32 + 16);
+            for (std::size_t i = 0; i < 8; ++i) {
+                __m512 a = _mm512_set1_ps(packedA[p * 8 + i]);
+                acc[i][0] = _mm512_fmadd_ps(a, b0, acc[i][0]);
+                acc[i][1] = _mm512_fmadd_ps(a, b1, acc[i][1]);
+            }
+        }
+        for (std::size_t i = 0; i < 8; ++i) {
+            float* row = c + i * ldc;
+            _mm512_storeu_ps(row, _mm512_add_ps(_mm512_loadu_ps(row), acc[i][0]));
+            _mm512_storeu_ps(row + 16, _mm512_add_ps(_mm512_loadu_ps(row + 16), acc[i][1]));
+        }
+    }
+#endif
+}
+
+// 与向量指令共用 VectorIsa()，SetVectorIsa 同样可以限制 GEMM 使用的指令集
+GemmMicroKernel<float> SelectGemmKernelF32() {
+#ifdef ASL_MATMUL_X86
+    switch (VectorIsa()) {
+    case IsaVariant::AVX512:
+        return GemmMicroKernel<float>{8, 32, &GemmKernelAvx512};
+    case IsaVariant::AVX2:
+        return GemmMicroKernel<float>{6, 16, &GemmKernelAvx2};
+    default:
+        break;
+    }
+#endif
+    return GemmMicroKernel<float>{4, 8, &GenericGemmKernel<float, 4, 8>};
+}
+
+}
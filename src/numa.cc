@@ -0,0 +1,144 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "numa.h"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace asl {
+
+namespace {
+    std::vector<int> AllowedCpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+        if (cpus.empty()) {
+            unsigned count = std::max(std::thread::hardware_concurrency(), 1u);
+            for (unsigned cpu = 0; cpu < count; ++cpu) {
+                cpus.push_back(static_cast<int>(cpu));
+            }
+        }
+        return cpus;
+    }
+
+    // 读取 sysNodePath 下所有 nodeN 目录的编号
+    std::vector<int> ListNodeIds(const std::string& sysNodePath) {
+        std::vector<int> ids;
+        DIR* dir = opendir(sysNodePath.c_str());
+        if (dir == nullptr) {
+            return ids;
+        }
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+                std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                ids.push_back(std::atoi(name.c_str() + 4));
+            }
+        }
+        closedir(dir);
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+}
+
+std::vector<int> ParseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(std::remove_if(item.begin(), item.end(), [](char c) { return c == ' ' || c == '\n'; }), item.end());
+        if (item.empty()) {
+            continue;
+        }
+        auto dash = item.find('-');
+        int first = std::atoi(item.substr(0, dash).c_str());
+        int last = dash == std::string::npos ? first : std::atoi(item.substr(dash + 1).c_str());
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+NumaTopology NumaTopology::SingleNode(std::size_t cpuCount) {
+    NumaTopology topology;
+    NumaNode node{0, {}};
+    for (std::size_t cpu = 0; cpu < std::max<std::size_t>(cpuCount, 1); ++cpu) {
+        node.cpus.push_back(static_cast<int>(cpu));
+    }
+    topology.nodes_.push_back(node);
+    return topology;
+}
+
+NumaTopology NumaTopology::Detect(const std::string& sysNodePath, bool onlyAllowedCpus) {
+    std::vector<int> allowed = onlyAllowedCpus ? AllowedCpus() : std::vector<int>();
+
+    NumaTopology topology;
+    for (int id : ListNodeIds(sysNodePath)) {
+        std::ifstream file(sysNodePath + "/node" + std::to_string(id) + "/cpulist");
+        std::string list;
+        std::getline(file, list);
+
+        NumaNode node{id, ParseCpuList(list)};
+        if (onlyAllowedCpus) {
+            node.cpus.erase(std::remove_if(node.cpus.begin(), node.cpus.end(), [&allowed](int cpu) {
+                return std::find(allowed.begin(), allowed.end(), cpu) == allowed.end();
+            }), node.cpus.end());
+        }
+        if (!node.cpus.empty()) {
+            topology.nodes_.push_back(node);
+        }
+    }
+
+    if (topology.nodes_.empty()) {
+        if (!onlyAllowedCpus) {
+            allowed = AllowedCpus();
+        }
+        topology.nodes_.push_back(NumaNode{0, allowed});
+    }
+    return topology;
+}
+
+std::size_t NumaTopology::CpuCount() const {
+    std::size_t count = 0;
+    for (auto& node : nodes_) {
+        count += node.cpus.size();
+    }
+    return count;
+}
+
+std::size_t NumaTopology::NodeOfCpu(int cpu) const {
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        if (std::find(nodes_[i].cpus.begin(), nodes_[i].cpus.end(), cpu) != nodes_[i].cpus.end()) {
+            return i;
+        }
+    }
+    return nodes_.size();
+}
+
+bool PinCurrentThread(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+}
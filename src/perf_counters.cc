@@ -0,0 +1,193 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "perf_counters.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include "profiler.h"
+
+namespace asl {
+
+namespace {
+    struct EventConfig {
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+
+    constexpr std::uint64_t CacheConfig(std::uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    const EventConfig EVENT_CONFIGS[PERF_EVENT_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, CacheConfig(PERF_COUNT_HW_CACHE_LL)},
+        {PERF_TYPE_HW_CACHE, CacheConfig(PERF_COUNT_HW_CACHE_DTLB)},
+    };
+
+    int OpenEvent(const EventConfig& event, int groupFd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+
+    // 当前线程的计数器组：第一个打开成功的事件作为组长，其余事件加入同一组以便一次 read 读出
+    class ThreadCounterGroup {
+    public:
+        ThreadCounterGroup() {
+            for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+                int fd = OpenEvent(EVENT_CONFIGS[i], leader_);
+                if (fd < 0) {
+                    continue;
+                }
+                if (leader_ < 0) {
+                    leader_ = fd;
+                }
+                fds_[opened_] = fd;
+                events_[opened_++] = i;
+            }
+            if (leader_ >= 0) {
+                ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+        }
+
+        ~ThreadCounterGroup() {
+            for (std::size_t i = 0; i < opened_; ++i) {
+                close(fds_[i]);
+            }
+        }
+
+        bool Available() const {
+            return leader_ >= 0;
+        }
+
+        bool Read(PerfSample& sample) const {
+            if (leader_ < 0) {
+                return false;
+            }
+            // PERF_FORMAT_GROUP 布局：nr, time_enabled, time_running, value[nr]
+            std::uint64_t buffer[3 + PERF_EVENT_COUNT];
+            if (read(leader_, buffer, sizeof(buffer)) < static_cast<ssize_t>((3 + opened_) * sizeof(std::uint64_t))) {
+                return false;
+            }
+            double scale = buffer[2] == 0 ? 0.0 : static_cast<double>(buffer[1]) / buffer[2];
+            sample = PerfSample();
+            for (std::size_t i = 0; i < opened_ && i < buffer[0]; ++i) {
+                sample.values[events_[i]] = static_cast<std::uint64_t>(buffer[3 + i] * scale);
+                sample.valid[events_[i]] = true;
+            }
+            return true;
+        }
+
+    private:
+        int leader_{-1};
+        int fds_[PERF_EVENT_COUNT]{};
+        std::size_t events_[PERF_EVENT_COUNT]{};
+        std::size_t opened_{0};
+    };
+
+    ThreadCounterGroup& CurrentGroup() {
+        thread_local ThreadCounterGroup group;
+        return group;
+    }
+
+    struct Aggregates {
+        std::mutex mutex;
+        std::map<const char*, KernelCounters> counters;
+    };
+
+    Aggregates& GetAggregates() {
+        static Aggregates aggregates;
+        return aggregates;
+    }
+}
+
+std::atomic<bool>& PerfCounters::Enabled() {
+    static std::atomic<bool> enabled{[]() {
+        const char* env = std::getenv("ASL_PERF_COUNTERS");
+        return env != nullptr && std::strcmp(env, "0") != 0;
+    }()};
+    return enabled;
+}
+
+bool PerfCounters::Available() {
+    return CurrentGroup().Available();
+}
+
+bool PerfCounters::Read(PerfSample& sample) {
+    return CurrentGroup().Read(sample);
+}
+
+void PerfCounters::Accumulate(const char* signature, std::size_t elements, const PerfSample& delta) {
+    auto& aggregates = GetAggregates();
+    std::lock_guard<std::mutex> lock(aggregates.mutex);
+    auto& counters = aggregates.counters[signature];
+    counters.samples++;
+    counters.elements += elements;
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        counters.values[i] += delta.values[i];
+        counters.valid[i] = counters.valid[i] || delta.valid[i];
+    }
+}
+
+std::map<std::string, KernelCounters> PerfCounters::Snapshot() {
+    std::map<std::string, KernelCounters> snapshot;
+    auto& aggregates = GetAggregates();
+    std::lock_guard<std::mutex> lock(aggregates.mutex);
+    for (auto& entry : aggregates.counters) {
+        // 不同翻译单元中同一类型的 name 指针可能不同，按可读名再合并一次
+        auto& counters = snapshot[DemangleName(entry.first)];
+        counters.samples += entry.second.samples;
+        counters.elements += entry.second.elements;
+        for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            counters.values[i] += entry.second.values[i];
+            counters.valid[i] = counters.valid[i] || entry.second.valid[i];
+        }
+    }
+    return snapshot;
+}
+
+void PerfCounters::Reset() {
+    auto& aggregates = GetAggregates();
+    std::lock_guard<std::mutex> lock(aggregates.mutex);
+    aggregates.counters.clear();
+}
+
+std::string PerfCounters::Dump() {
+    auto perKilo = [](const KernelCounters& counters, PerfEvent event) {
+        return counters.elements == 0 ? 0.0 : counters[event] * 1000.0 / counters.elements;
+    };
+
+    std::string text;
+    char line[512];
+    std::snprintf(line, sizeof(line), "%-10s %12s %16s %16s %8s %14s %14s  %s\n",
+                  "samples", "elements", "cycles", "instructions", "IPC", "LLC miss/1k", "dTLB miss/1k", "kernel");
+    text += line;
+    for (auto& entry : Snapshot()) {
+        const KernelCounters& counters = entry.second;
+        std::snprintf(line, sizeof(line), "%-10zu %12zu %16llu %16llu %8.2f %14.3f %14.3f  %s\n",
+                      counters.samples, counters.elements,
+                      static_cast<unsigned long long>(counters[PerfEvent::CYCLES]),
+                      static_cast<unsigned long long>(counters[PerfEvent::INSTRUCTIONS]),
+                      counters.Ipc(), perKilo(counters, PerfEvent::LLC_MISSES), perKilo(counters, PerfEvent::DTLB_MISSES),
+                      entry.first.c_str());
+        text += line;
+    }
+    return text;
+}
+
+}
@@ -0,0 +1,214 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "plan_cache.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace asl {
+
+namespace {
+    constexpr char PLAN_MAGIC[8] = {'A', 'S', 'L', 'P', 'L', 'A', 'N', '\0'};
+
+    struct PlanFileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t planSize;
+        std::uint64_t count;
+    };
+
+    static_assert(std::is_trivially_copyable<ExecutionPlan>::value, "ExecutionPlan should be POD!");
+    static_assert(sizeof(PlanFileHeader) % alignof(ExecutionPlan) == 0, "plans should be aligned after header!");
+
+    bool WriteAll(int fd, const void* data, std::size_t bytes) {
+        const char* pos = static_cast<const char*>(data);
+        while (bytes > 0) {
+            ssize_t written = write(fd, pos, bytes);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+            pos += written;
+            bytes -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    bool KeyLess(const ExecutionPlan& plan, const std::tuple<std::uint64_t, std::uint32_t, std::uint32_t>& key) {
+        return plan.Key() < key;
+    }
+}
+
+IsaVariant DetectIsa() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return IsaVariant::AVX512;
+    }
+    // AVX2 路径的 Exp 等用到 FMA 指令，两者都支持时才选用
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return IsaVariant::AVX2;
+    }
+#endif
+    return IsaVariant::SCALAR;
+}
+
+const char* IsaName(IsaVariant isa) {
+    switch (isa) {
+    case IsaVariant::AVX2:
+        return "avx2";
+    case IsaVariant::AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+std::uint64_t PlanSignatureHash(std::string_view signature) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : signature) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+PlanCache::~PlanCache() {
+    Unmap();
+}
+
+void PlanCache::Unmap() {
+    if (mapAddr_ != nullptr) {
+        munmap(mapAddr_, mapBytes_);
+    }
+    mapAddr_ = nullptr;
+    mapBytes_ = 0;
+    mapped_ = nullptr;
+    mappedCount_ = 0;
+}
+
+bool PlanCache::Open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Unmap();
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(PlanFileHeader)) {
+        close(fd);
+        return false;
+    }
+    std::size_t bytes = static_cast<std::size_t>(st.st_size);
+    void* addr = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    const auto* header = static_cast<const PlanFileHeader*>(addr);
+    bool valid = std::memcmp(header->magic, PLAN_MAGIC, sizeof(PLAN_MAGIC)) == 0 &&
+                 header->version == VERSION && header->planSize == sizeof(ExecutionPlan) &&
+                 header->count <= (bytes - sizeof(PlanFileHeader)) / sizeof(ExecutionPlan) &&
+                 bytes == sizeof(PlanFileHeader) + header->count * sizeof(ExecutionPlan);
+    if (!valid) {
+        munmap(addr, bytes);
+        return false;
+    }
+    mapAddr_ = addr;
+    mapBytes_ = bytes;
+    mapped_ = reinterpret_cast<const ExecutionPlan*>(static_cast<const char*>(addr) + sizeof(PlanFileHeader));
+    mappedCount_ = header->count;
+    return true;
+}
+
+bool PlanCache::Find(std::string_view signature, std::uint32_t countBucket, IsaVariant isa, ExecutionPlan& plan) const {
+    auto key = std::make_tuple(PlanSignatureHash(signature), countBucket, static_cast<std::uint32_t>(isa));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = inserted_.find(key);
+    if (found != inserted_.end()) {
+        plan = found->second;
+        return true;
+    }
+    const ExecutionPlan* end = mapped_ + mappedCount_;
+    const ExecutionPlan* pos = std::lower_bound(mapped_, end, key, KeyLess);
+    if (pos == end || pos->Key() != key) {
+        return false;
+    }
+    plan = *pos;
+    return true;
+}
+
+void PlanCache::Insert(const ExecutionPlan& plan) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inserted_[plan.Key()] = plan;
+}
+
+std::size_t PlanCache::Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t size = inserted_.size();
+    for (std::size_t i = 0; i < mappedCount_; ++i) {
+        size += inserted_.count(mapped_[i].Key()) == 0 ? 1 : 0;
+    }
+    return size;
+}
+
+void PlanCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inserted_.clear();
+    Unmap();
+}
+
+bool PlanCache::Save(const std::string& path) const {
+    std::vector<ExecutionPlan> plans;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < mappedCount_; ++i) {
+            if (inserted_.count(mapped_[i].Key()) == 0) {
+                plans.push_back(mapped_[i]);
+            }
+        }
+        for (auto& entry : inserted_) {
+            plans.push_back(entry.second);
+        }
+    }
+    std::sort(plans.begin(), plans.end(), [](const ExecutionPlan& a, const ExecutionPlan& b) {
+        return a.Key() < b.Key();
+    });
+
+    PlanFileHeader header;
+    std::memcpy(header.magic, PLAN_MAGIC, sizeof(PLAN_MAGIC));
+    header.version = VERSION;
+    header.planSize = sizeof(ExecutionPlan);
+    header.count = plans.size();
+
+    // 多个进程可能同时保存同一个文件：各自写入同目录下唯一的临时文件，落盘后再原子地 rename 覆盖
+    std::string temp = path + ".XXXXXX";
+    int fd = mkstemp(&temp[0]);
+    if (fd < 0) {
+        return false;
+    }
+    bool written = fchmod(fd, 0644) == 0 && WriteAll(fd, &header, sizeof(header)) &&
+                   WriteAll(fd, plans.data(), plans.size() * sizeof(ExecutionPlan)) && fsync(fd) == 0;
+    written = close(fd) == 0 && written;
+    if (!written || std::rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,161 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "profiler.h"
+#include <cxxabi.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace asl {
+
+namespace {
+    // 每个线程一个缓冲区；注册表持有 shared_ptr，线程退出后记录仍然保留
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::vector<LaunchRecord> records;
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        std::uint32_t nextThreadId{0};
+    };
+
+    Registry& GetRegistry() {
+        static Registry registry;
+        return registry;
+    }
+
+    struct ThreadState {
+        ThreadState() : buffer(std::make_shared<ThreadBuffer>()) {
+            auto& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.buffers.push_back(buffer);
+            threadId = registry.nextThreadId++;
+        }
+
+        std::shared_ptr<ThreadBuffer> buffer;
+        std::uint32_t threadId;
+    };
+
+    ThreadState& CurrentThreadState() {
+        thread_local ThreadState state;
+        return state;
+    }
+
+    std::string EscapeJson(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped.push_back('\\');
+            }
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+}
+
+std::string DemangleName(const char* name) {
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> demangled(abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free);
+    return status == 0 && demangled ? std::string(demangled.get()) : std::string(name);
+}
+
+std::atomic<bool>& Profiler::Enabled() {
+    static std::atomic<bool> enabled{[]() {
+        const char* env = std::getenv("ASL_PROFILE");
+        return env != nullptr && std::strcmp(env, "0") != 0;
+    }()};
+    return enabled;
+}
+
+std::uint64_t Profiler::NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::uint32_t Profiler::CurrentThreadId() {
+    return CurrentThreadState().threadId;
+}
+
+void Profiler::Record(const LaunchRecord& record) {
+    auto& buffer = *CurrentThreadState().buffer;
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.records.push_back(record);
+}
+
+std::vector<LaunchRecord> Profiler::Collect() {
+    std::vector<LaunchRecord> records;
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& buffer : registry.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        records.insert(records.end(), buffer->records.begin(), buffer->records.end());
+    }
+    std::stable_sort(records.begin(), records.end(), [](const LaunchRecord& a, const LaunchRecord& b) {
+        return a.startNs < b.startNs;
+    });
+    return records;
+}
+
+void Profiler::Clear() {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& buffer : registry.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->records.clear();
+    }
+}
+
+std::string Profiler::ChromeTrace() {
+    std::vector<LaunchRecord> records = Collect();
+    std::map<const char*, std::string> names;
+
+    std::ostringstream os;
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const auto& record = records[i];
+        auto found = names.find(record.name);
+        if (found == names.end()) {
+            found = names.emplace(record.name, EscapeJson(DemangleName(record.name))).first;
+        }
+        char timing[96];
+        std::snprintf(timing, sizeof(timing), "\"ts\":%.3f,\"dur\":%.3f",
+                      record.startNs / 1e3, (record.endNs - record.startNs) / 1e3);
+        char gbps[32];
+        std::snprintf(gbps, sizeof(gbps), "%.3f", record.GBps());
+
+        os << (i == 0 ? "" : ",")
+           << "{\"name\":\"" << found->second << "\""
+           << ",\"cat\":\"" << (record.kind == RecordKind::LAUNCH ? "launch" : "block") << "\""
+           << ",\"ph\":\"X\"," << timing
+           << ",\"pid\":" << getpid() << ",\"tid\":" << record.threadId
+           << ",\"args\":{\"count\":" << record.count
+           << ",\"bytesRead\":" << record.bytesRead
+           << ",\"bytesWritten\":" << record.bytesWritten
+           << ",\"GBps\":" << gbps << "}}";
+    }
+    os << "]}";
+    return os.str();
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << ChromeTrace();
+    return static_cast<bool>(file);
+}
+
+}
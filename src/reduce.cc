@@ -0,0 +1,58 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "reduce.h"
+#include <stdexcept>
+#include <string>
+
+namespace asl {
+
+namespace {
+    std::vector<bool> ReducedMask(const std::vector<std::size_t>& dims, const std::vector<std::size_t>& axes) {
+        std::vector<bool> reduced(dims.size(), false);
+        for (std::size_t axis : axes) {
+            if (axis >= dims.size()) {
+                throw std::invalid_argument("reduce axis " + std::to_string(axis) + " out of range for " +
+                                            std::to_string(dims.size()) + "-d tensor");
+            }
+            if (reduced[axis]) {
+                throw std::invalid_argument("reduce axis " + std::to_string(axis) + " is repeated");
+            }
+            reduced[axis] = true;
+        }
+        return reduced;
+    }
+}
+
+std::vector<ReduceSegment> CollapseReduceAxes(const std::vector<std::size_t>& dims, const std::vector<std::size_t>& axes) {
+    std::vector<bool> reduced = ReducedMask(dims, axes);
+    std::vector<ReduceSegment> segments;
+    for (std::size_t i = 0; i < dims.size(); ++i) {
+        if (dims[i] == 1) {
+            continue;
+        }
+        if (!segments.empty() && segments.back().reduced == reduced[i]) {
+            segments.back().size *= dims[i];
+        } else {
+            segments.push_back(ReduceSegment{dims[i], reduced[i]});
+        }
+    }
+    return segments;
+}
+
+std::vector<std::size_t> ReduceOutputDims(const std::vector<std::size_t>& dims, const std::vector<std::size_t>& axes,
+                                          bool keepDims) {
+    std::vector<bool> reduced = ReducedMask(dims, axes);
+    std::vector<std::size_t> output;
+    for (std::size_t i = 0; i < dims.size(); ++i) {
+        if (!reduced[i]) {
+            output.push_back(dims[i]);
+        } else if (keepDims) {
+            output.push_back(1);
+        }
+    }
+    return output;
+}
+
+}
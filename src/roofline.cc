@@ -0,0 +1,117 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "roofline.h"
+#include <cstdio>
+#include "kernel_ops.h"
+
+namespace asl {
+
+namespace {
+    constexpr std::size_t FMA_CHAINS = 16;
+    constexpr std::size_t FMA_ITERATIONS = std::size_t(1) << 22;
+
+    // 互不依赖的乘加链，编译器可以把它们向量化并填满浮点流水线
+    double FmaChains(std::size_t iterations) {
+        double acc[FMA_CHAINS];
+        for (std::size_t j = 0; j < FMA_CHAINS; ++j) {
+            acc[j] = 1.0 + j * 1e-3;
+        }
+        for (std::size_t i = 0; i < iterations; ++i) {
+            for (std::size_t j = 0; j < FMA_CHAINS; ++j) {
+                acc[j] = acc[j] * 0.999999 + 1e-6;
+            }
+        }
+        double sum = 0.0;
+        for (double value : acc) {
+            sum += value;
+        }
+        return sum;
+    }
+
+    template <typename F>
+    double BestSeconds(std::size_t repeat, F&& f) {
+        double best = 0.0;
+        for (std::size_t i = 0; i < std::max<std::size_t>(repeat, 1); ++i) {
+            std::uint64_t start = Profiler::NowNs();
+            f();
+            double seconds = (Profiler::NowNs() - start) * 1e-9;
+            best = (i == 0 || seconds < best) ? seconds : best;
+        }
+        return best;
+    }
+}
+
+MachinePeak MeasureMachinePeak(ThreadPool& pool, std::size_t bytesPerThread, std::size_t repeat) {
+    std::size_t threads = pool.Size();
+    std::size_t elems = std::max<std::size_t>(bytesPerThread / (3 * sizeof(double)), 1);
+
+    // 各线程在自己的工作线程上分配并首次访问自己的数组，使页落在本地节点
+    std::vector<std::vector<double>> arrays(threads * 3);
+    pool.Dispatch(threads, [&arrays, elems](std::size_t t) {
+        arrays[t * 3 + 0].assign(elems, 0.0);
+        arrays[t * 3 + 1].assign(elems, 1.0);
+        arrays[t * 3 + 2].assign(elems, 2.0);
+    });
+
+    double triadSeconds = BestSeconds(repeat, [&pool, &arrays, elems, threads]() {
+        pool.Dispatch(threads, [&arrays, elems](std::size_t t) {
+            double* __restrict__ a = arrays[t * 3 + 0].data();
+            const double* __restrict__ b = arrays[t * 3 + 1].data();
+            const double* __restrict__ c = arrays[t * 3 + 2].data();
+            for (std::size_t i = 0; i < elems; ++i) {
+                a[i] = b[i] + 3.0 * c[i];
+            }
+        });
+    });
+
+    std::vector<double> sinks(threads);
+    double fmaSeconds = BestSeconds(repeat, [&pool, &sinks, threads]() {
+        pool.Dispatch(threads, [&sinks](std::size_t t) { sinks[t] = FmaChains(FMA_ITERATIONS); });
+    });
+
+    MachinePeak peak;
+    double bytes = 3.0 * sizeof(double) * elems * threads;
+    double flops = 2.0 * FMA_CHAINS * FMA_ITERATIONS * threads;
+    peak.bandwidthGBps = triadSeconds == 0.0 ? 0.0 : bytes / triadSeconds * 1e-9;
+    peak.gflops = fmaSeconds == 0.0 || sinks[0] == 0.0 ? 0.0 : flops / fmaSeconds * 1e-9;
+    return peak;
+}
+
+double RooflineReport::Efficiency(const RooflinePoint& point) const {
+    if (MemoryBound(point)) {
+        return peak_.bandwidthGBps == 0.0 ? 0.0 : point.GBps() / peak_.bandwidthGBps;
+    }
+    return peak_.gflops == 0.0 ? 0.0 : point.Gflops() / peak_.gflops;
+}
+
+std::string RooflineReport::Format() const {
+    std::string text;
+    char line[256];
+    std::snprintf(line, sizeof(line), "peak bandwidth %.2f GB/s, peak compute %.2f GFLOP/s, ridge %.3f FLOP/B\n",
+                  peak_.bandwidthGBps, peak_.gflops, peak_.RidgeIntensity());
+    text += line;
+    std::snprintf(line, sizeof(line), "%-24s %10s %10s %10s %12s %8s %8s\n",
+                  "kernel", "FLOP/B", "GB/s", "GFLOP/s", "attainable", "bound", "eff");
+    text += line;
+    for (auto& point : points_) {
+        std::snprintf(line, sizeof(line), "%-24s %10.3f %10.2f %10.2f %12.2f %8s %7.1f%%\n",
+                      point.name.c_str(), point.Intensity(), point.GBps(), point.Gflops(),
+                      AttainableGflops(point), MemoryBound(point) ? "memory" : "compute",
+                      Efficiency(point) * 100.0);
+        text += line;
+    }
+    return text;
+}
+
+void MeasurePrebuiltKernels(RooflineReport& report, ThreadPool& pool, std::size_t count) {
+#define ASL_MEASURE_PREBUILT_ELEM_WISE(OP, T) \
+    report.Measure<BinaryElemWise<OP, T>>(pool, #OP "<" #T ">", count);
+
+    ASL_FOR_EACH_PREBUILT_ELEM_WISE(ASL_MEASURE_PREBUILT_ELEM_WISE)
+
+#undef ASL_MEASURE_PREBUILT_ELEM_WISE
+}
+
+}
@@ -0,0 +1,235 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "kernel_ops.h"
+#include "thread_pool.h"
+
+namespace asl {
+
+namespace {
+    struct SimState {
+        std::mutex mutex;
+        MachineModel model;
+        std::vector<SimRecord> records;
+    };
+
+    SimState& State() {
+        static SimState state;
+        return state;
+    }
+
+    struct StageCycles {
+        double in;
+        double vector;
+        double out;
+    };
+
+    // 单个 block 的三级流水推演：depth 为每级之间的缓冲数
+    // 第 i 块搬入需要等第 i - depth 块的计算释放输入缓冲，第 i 块计算需要等第 i - depth 块搬出释放输出缓冲
+    double PipelineCycles(const std::vector<StageCycles>& tiles, std::size_t depth) {
+        std::vector<double> inEnd(tiles.size()), computeEnd(tiles.size()), outEnd(tiles.size());
+        for (std::size_t i = 0; i < tiles.size(); ++i) {
+            double inStart = i > 0 ? inEnd[i - 1] : 0.0;
+            if (i >= depth) {
+                inStart = std::max(inStart, computeEnd[i - depth]);
+            }
+            inEnd[i] = inStart + tiles[i].in;
+
+            double computeStart = std::max(inEnd[i], i > 0 ? computeEnd[i - 1] : 0.0);
+            if (i >= depth) {
+                computeStart = std::max(computeStart, outEnd[i - depth]);
+            }
+            computeEnd[i] = computeStart + tiles[i].vector;
+
+            outEnd[i] = std::max(computeEnd[i], i > 0 ? outEnd[i - 1] : 0.0) + tiles[i].out;
+        }
+        return tiles.empty() ? 0.0 : outEnd.back();
+    }
+}
+
+const char* SimBoundName(SimBound bound) {
+    switch (bound) {
+        case SimBound::MTE_IN:       return "mte-in";
+        case SimBound::VECTOR:       return "vector";
+        case SimBound::MTE_OUT:      return "mte-out";
+        case SimBound::GM_BANDWIDTH: return "gm";
+    }
+    return "unknown";
+}
+
+std::atomic<bool>& Simulator::Enabled() {
+    static std::atomic<bool> enabled{[]() {
+        const char* env = std::getenv("ASL_SIMULATE");
+        return env != nullptr && std::strcmp(env, "0") != 0;
+    }()};
+    return enabled;
+}
+
+void Simulator::SetModel(const MachineModel& model) {
+    std::lock_guard<std::mutex> lock(State().mutex);
+    State().model = model;
+}
+
+MachineModel Simulator::Model() {
+    std::lock_guard<std::mutex> lock(State().mutex);
+    return State().model;
+}
+
+SimEstimate Simulator::Estimate(const MachineModel& model, const SimWorkload& workload) {
+    SimEstimate estimate;
+    std::size_t coreNum = std::max<std::size_t>(model.coreNum, 1);
+    std::size_t activeCores = std::min(coreNum, std::max<std::size_t>(workload.size(), 1));
+    estimate.waves = (workload.size() + coreNum - 1) / coreNum;
+
+    // 同时搬运的核平分 GM 带宽
+    double clockHz = model.clockGHz * 1e9;
+    double mteRate = std::min(model.mteBytesPerCycle, model.gmBandwidthGBps * 1e9 / clockHz / activeCores);
+    auto copyCycles = [&](std::size_t bytes) {
+        return bytes == 0 ? 0.0 : model.copyLatencyCycles + bytes / mteRate;
+    };
+
+    std::vector<double> coreCycles(coreNum, 0.0);
+    std::vector<StageCycles> coreBusy(coreNum, StageCycles{0.0, 0.0, 0.0});
+    double totalBytes = 0.0;
+    for (std::size_t blockIdx = 0; blockIdx < workload.size(); ++blockIdx) {
+        std::vector<StageCycles> tiles;
+        tiles.reserve(workload[blockIdx].size());
+        StageCycles& busy = coreBusy[blockIdx % coreNum];
+        for (auto& tile : workload[blockIdx]) {
+            tiles.push_back(StageCycles{copyCycles(tile.copyInBytes), tile.vectorOps / model.vectorOpsPerCycle,
+                                        copyCycles(tile.copyOutBytes)});
+            busy.in += tiles.back().in;
+            busy.vector += tiles.back().vector;
+            busy.out += tiles.back().out;
+            totalBytes += tile.copyInBytes + tile.copyOutBytes;
+        }
+        coreCycles[blockIdx % coreNum] += PipelineCycles(tiles, model.doubleBuffer ? 2 : 1);
+    }
+
+    std::size_t critical = std::max_element(coreCycles.begin(), coreCycles.end()) - coreCycles.begin();
+    const StageCycles& busy = coreBusy[critical];
+    estimate.cycles = coreCycles[critical];
+    estimate.bound = busy.in >= busy.vector && busy.in >= busy.out ? SimBound::MTE_IN
+                   : busy.vector >= busy.out ? SimBound::VECTOR : SimBound::MTE_OUT;
+
+    double coreSeconds = estimate.cycles / clockHz;
+    double gmSeconds = totalBytes / (model.gmBandwidthGBps * 1e9);
+    if (gmSeconds > coreSeconds) {
+        estimate.bound = SimBound::GM_BANDWIDTH;
+    }
+    estimate.seconds = std::max(coreSeconds, gmSeconds) + model.launchOverheadUs * 1e-6;
+    return estimate;
+}
+
+SimEstimate Simulator::EstimateElemWise(const MachineModel& model, std::size_t count, std::size_t blockDim,
+                                        std::size_t tileSize, std::size_t inBytesPerElem,
+                                        std::size_t outBytesPerElem, double opsPerElem) {
+    blockDim = std::max<std::size_t>(blockDim, 1);
+    SimWorkload workload(blockDim);
+    for (std::size_t blockIdx = 0; blockIdx < blockDim; ++blockIdx) {
+        BlockRange range = BlockPartition(count, blockDim, blockIdx);
+        std::size_t tile = (tileSize == 0 || tileSize > range.count) ? range.count : tileSize;
+        std::size_t offset = 0;
+        do {
+            std::size_t elements = std::min(tile, range.count - offset);
+            workload[blockIdx].push_back(TileCost{inBytesPerElem * elements, outBytesPerElem * elements,
+                                                  static_cast<std::size_t>(std::ceil(opsPerElem * elements))});
+            offset += tile;
+        } while (offset < range.count);
+    }
+    return Estimate(model, workload);
+}
+
+void Simulator::Record(const SimRecord& record) {
+    std::lock_guard<std::mutex> lock(State().mutex);
+    State().records.push_back(record);
+}
+
+std::vector<SimRecord> Simulator::Records() {
+    std::lock_guard<std::mutex> lock(State().mutex);
+    return State().records;
+}
+
+void Simulator::Clear() {
+    std::lock_guard<std::mutex> lock(State().mutex);
+    State().records.clear();
+}
+
+std::string Simulator::Report() {
+    std::string text;
+    char line[512];
+    std::snprintf(line, sizeof(line), "%10s %8s %8s %12s %12s %8s  %s\n",
+                  "count", "blocks", "tile", "host(us)", "sim(us)", "bound", "kernel");
+    text += line;
+    // kernel 签名较长，放在最后一列
+    for (auto& record : Records()) {
+        std::snprintf(line, sizeof(line), "%10zu %8zu %8zu %12.2f %12.2f %8s  ",
+                      record.count, record.blockDim, record.tileSize, record.hostSeconds * 1e6,
+                      record.estimate.seconds * 1e6, SimBoundName(record.estimate.bound));
+        text += line;
+        text += DemangleName(record.name) + "\n";
+    }
+    return text;
+}
+
+void SimulatePrebuiltKernels(ThreadPool& pool, std::size_t count, const std::vector<std::size_t>& tileSizes) {
+    bool enabled = Simulator::IsEnabled();
+    Simulator::Enable();
+    for (std::size_t tileSize : tileSizes) {
+        LaunchConfig config{&pool, pool.Size(), LaunchSchedule::STATIC, tileSize};
+#define ASL_SIMULATE_PREBUILT_ELEM_WISE(OP, T)                                              \
+        {                                                                                   \
+            using KERNEL = BinaryElemWise<OP, T>;                                           \
+            std::vector<unsigned char> inputs(KERNEL::IN_BYTES * count, 1);                 \
+            std::vector<unsigned char> outputs(KERNEL::OUT_BYTES * count, 0);               \
+            KERNEL().RunWithConfig(config, inputs.data(), inputs.data(), outputs.data(), count); \
+        }
+
+        ASL_FOR_EACH_PREBUILT_ELEM_WISE(ASL_SIMULATE_PREBUILT_ELEM_WISE)
+
+#undef ASL_SIMULATE_PREBUILT_ELEM_WISE
+    }
+    Simulator::Enable(enabled);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+SimLaunch::SimLaunch(const char* name, std::size_t count, std::size_t blockDim, std::size_t tileSize,
+                     std::size_t inBytesPerElem, std::size_t outBytesPerElem, double opsPerElem)
+: active_(Simulator::IsEnabled()), name_(name), count_(count), blockDim_(std::max<std::size_t>(blockDim, 1)),
+  tileSize_(tileSize), inBytesPerElem_(inBytesPerElem), outBytesPerElem_(outBytesPerElem), opsPerElem_(opsPerElem) {
+    if (active_) {
+        workload_.resize(blockDim_);
+        startNs_ = Profiler::NowNs();
+    }
+}
+
+SimLaunch::~SimLaunch() {
+    if (!active_) {
+        return;
+    }
+    double hostSeconds = (Profiler::NowNs() - startNs_) * 1e-9;
+    Simulator::Record(SimRecord{name_, count_, blockDim_, tileSize_, hostSeconds,
+                                Simulator::Estimate(Simulator::Model(), workload_)});
+}
+
+void SimLaunch::RecordTile(std::size_t blockIdx, std::size_t elements, const TileCost& cost) {
+    TileCost tile = cost;
+    if (tile.copyInBytes == 0 && tile.copyOutBytes == 0) {
+        tile.copyInBytes = inBytesPerElem_ * elements;
+        tile.copyOutBytes = outBytesPerElem_ * elements;
+    }
+    if (tile.vectorOps == 0) {
+        tile.vectorOps = static_cast<std::size_t>(std::ceil(opsPerElem_ * elements));
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    workload_[blockIdx].push_back(tile);
+}
+
+}
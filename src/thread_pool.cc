@@ -0,0 +1,351 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace asl {
+
+namespace {
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local std::size_t currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(std::size_t threadNum) {
+    threadNum = std::max<std::size_t>(threadNum, 1);
+    Start(std::vector<std::size_t>(threadNum, 0), std::vector<std::vector<int>>(threadNum));
+}
+
+ThreadPool::ThreadPool(const NumaTopology& topology, std::size_t threadsPerNode) {
+    std::vector<std::size_t> workerNodes;
+    std::vector<std::vector<int>> workerCpus;
+    for (std::size_t node = 0; node < topology.NodeCount(); ++node) {
+        const auto& cpus = topology.Nodes()[node].cpus;
+        std::size_t threads = threadsPerNode == 0 ? std::max<std::size_t>(cpus.size(), 1) : threadsPerNode;
+        for (std::size_t i = 0; i < threads; ++i) {
+            workerNodes.push_back(node);
+            workerCpus.push_back(cpus);
+        }
+    }
+    nodeCount_ = std::max<std::size_t>(topology.NodeCount(), 1);
+    if (workerNodes.empty()) {
+        workerNodes.push_back(0);
+        workerCpus.emplace_back();
+    }
+    Start(std::move(workerNodes), std::move(workerCpus));
+}
+
+void ThreadPool::Start(std::vector<std::size_t> workerNodes, std::vector<std::vector<int>> workerCpus) {
+    workerNodes_ = std::move(workerNodes);
+    workerCpus_ = std::move(workerCpus);
+    std::size_t threadNum = workerNodes_.size();
+    pinnedTasks_.resize(threadNum);
+    for (std::size_t i = 0; i < threadNum; ++i) {
+        localJobs_.emplace_back(new ChaseLevDeque<Job*>());
+
+        std::vector<std::size_t> sameNode, otherNodes;
+        for (std::size_t k = 1; k < threadNum; ++k) {
+            std::size_t victim = (i + k) % threadNum;
+            (workerNodes_[victim] == workerNodes_[i] ? sameNode : otherNodes).push_back(victim);
+        }
+        sameNode.insert(sameNode.end(), otherNodes.begin(), otherNodes.end());
+        victims_.push_back(std::move(sameNode));
+    }
+    workers_.reserve(threadNum);
+    for (std::size_t i = 0; i < workerNodes_.size(); ++i) {
+        workers_.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+std::size_t ThreadPool::DefaultThreadNum() {
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+ThreadPool& ThreadPool::Default() {
+    static std::unique_ptr<ThreadPool> pool = []() {
+        NumaTopology topology = NumaTopology::Detect();
+        return topology.NodeCount() > 1 ? std::make_unique<ThreadPool>(topology) : std::make_unique<ThreadPool>();
+    }();
+    return *pool;
+}
+
+void ThreadPool::Post(Job task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(new Job(std::move(task)));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::PostTo(std::size_t worker, Job task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pinnedTasks_[worker].push_back(new Job(std::move(task)));
+    }
+    // 所有工作线程共用一个条件变量，必须全部唤醒才能保证目标线程被唤醒
+    cv_.notify_all();
+}
+
+void ThreadPool::Spawn(Job task) {
+    std::size_t worker = CurrentWorker();
+    if (worker == workers_.size()) {
+        Post(std::move(task));
+        return;
+    }
+    localJobs_[worker]->Push(new Job(std::move(task)));
+    // 与 WorkerLoop 中 "登记休眠后再窃取" 对称：压入后再检查休眠线程，二者至少有一方能看到对方
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_one();
+    }
+}
+
+std::size_t ThreadPool::CurrentWorker() const {
+    return currentPool == this ? currentWorker : workers_.size();
+}
+
+void ThreadPool::WorkerLoop(std::size_t worker) {
+    currentPool = this;
+    currentWorker = worker;
+    if (!workerCpus_[worker].empty()) {
+        // 绑定失败（例如 CPU 不在当前 cgroup 中）时保持不绑定继续运行
+        PinCurrentThread(workerCpus_[worker]);
+    }
+    for (;;) {
+        // 依次查找：自己队列的底端、派发给本线程的任务与共享队列、其他线程队列的顶端
+        Job* job = nullptr;
+        if (!localJobs_[worker]->Pop(job)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                job = TakeShared(worker);
+            }
+            if (job == nullptr) {
+                job = StealFor(worker);
+            }
+        }
+        if (job == nullptr) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while ((job = TakeShared(worker)) == nullptr) {
+                // 先登记休眠再窃取，与 Spawn 中 "压入后检查 sleepers_" 对称，避免丢失唤醒
+                sleepers_.fetch_add(1);
+                job = StealFor(worker);
+                if (job == nullptr) {
+                    if (stopping_) {
+                        sleepers_.fetch_sub(1);
+                        return;
+                    }
+                    cv_.wait(lock);
+                }
+                sleepers_.fetch_sub(1);
+                if (job != nullptr) {
+                    break;
+                }
+            }
+        }
+        RunJob(job);
+    }
+}
+
+ThreadPool::Job* ThreadPool::TakeShared(std::size_t worker) {
+    // 优先执行派发给本线程的任务
+    auto& pinned = pinnedTasks_[worker];
+    auto& queue = pinned.empty() ? tasks_ : pinned;
+    if (queue.empty()) {
+        return nullptr;
+    }
+    Job* job = queue.front();
+    queue.pop_front();
+    return job;
+}
+
+ThreadPool::Job* ThreadPool::StealFor(std::size_t worker) {
+    Job* job = nullptr;
+    for (std::size_t victim : victims_[worker]) {
+        if (localJobs_[victim]->Steal(job)) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::RunJob(Job* job) {
+    std::unique_ptr<Job> owned(job);
+    (*owned)();
+}
+
+namespace {
+    // ParallelFor 的共享状态：帮助任务可能在调用返回后才被调度，因此以 shared_ptr 持有
+    struct ParallelForState {
+        ParallelForState(std::size_t n, const std::function<void(std::size_t)>& f) : total(n), func(&f) {}
+
+        // 领取并执行下标，直到全部下标被领取
+        void Drain() {
+            for (;;) {
+                std::size_t index = next.fetch_add(1);
+                if (index >= total) {
+                    return;
+                }
+                try {
+                    (*func)(index);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+                if (done.fetch_add(1) + 1 == total) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    cv.notify_all();
+                }
+            }
+        }
+
+        const std::size_t total;
+        const std::function<void(std::size_t)>* func;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr error;
+    };
+}
+
+void ThreadPool::ParallelFor(std::size_t n, const std::function<void(std::size_t)>& f) {
+    if (n == 0) {
+        return;
+    }
+    if (n == 1) {
+        f(0);
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>(n, f);
+    std::size_t helpers = std::min(n - 1, workers_.size());
+    for (std::size_t i = 0; i < helpers; ++i) {
+        Spawn([state]() { state->Drain(); });
+    }
+    state->Drain();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&state]() { return state->done.load() == state->total; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+void ThreadPool::Dispatch(std::size_t n, const std::function<void(std::size_t)>& f) {
+    if (n == 0) {
+        return;
+    }
+    if (CurrentWorker() != workers_.size()) {
+        ParallelFor(n, f);
+        return;
+    }
+
+    struct DispatchState {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t remaining;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<DispatchState>();
+    state->remaining = n;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        PostTo(i % workers_.size(), [state, &f, i]() {
+            std::exception_ptr error;
+            try {
+                f(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error) {
+                state->error = error;
+            }
+            if (--state->remaining == 0) {
+                state->cv.notify_all();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&state]() { return state->remaining == 0; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+struct ThreadPool::StealingState {
+    StealingState(std::size_t n, const std::function<void(std::size_t)>& f) : remaining(n), func(&f) {}
+
+    void Finish() {
+        if (remaining.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        }
+    }
+
+    std::atomic<std::size_t> remaining;
+    const std::function<void(std::size_t)>* func;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+};
+
+void ThreadPool::SplitRange(const std::shared_ptr<StealingState>& state, std::size_t begin, std::size_t end) {
+    // 右半部分留给窃取者，自己继续二分左半部分；所属线程随后按 LIFO 顺序弹出，恰好从左到右处理
+    while (end - begin > 1) {
+        std::size_t mid = begin + (end - begin) / 2;
+        Spawn([this, state, mid, end]() { SplitRange(state, mid, end); });
+        end = mid;
+    }
+    try {
+        (*state->func)(begin);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->error) {
+            state->error = std::current_exception();
+        }
+    }
+    state->Finish();
+}
+
+void ThreadPool::DispatchStealing(std::size_t n, std::size_t chunks, const std::function<void(std::size_t)>& f) {
+    chunks = std::max<std::size_t>(chunks, 1);
+    if (n == 0) {
+        return;
+    }
+    if (CurrentWorker() != workers_.size()) {
+        ParallelFor(n * chunks, f);
+        return;
+    }
+
+    auto state = std::make_shared<StealingState>(n * chunks, f);
+    for (std::size_t i = 0; i < n; ++i) {
+        PostTo(i % workers_.size(), [this, state, i, chunks]() { SplitRange(state, i * chunks, (i + 1) * chunks); });
+    }
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&state]() { return state->remaining.load() == 0; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+}
@@ -0,0 +1,33 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "tiling.h"
+
+namespace asl {
+
+namespace {
+    thread_local std::size_t currentBlockIdx = 0;
+    thread_local std::size_t currentBlockNum = 1;
+}
+
+std::size_t GetBlockIdx() {
+    return currentBlockIdx;
+}
+
+std::size_t GetBlockNum() {
+    return currentBlockNum;
+}
+
+BlockScope::BlockScope(std::size_t blockIdx, std::size_t blockNum)
+: savedIdx_(currentBlockIdx), savedNum_(currentBlockNum) {
+    currentBlockIdx = blockIdx;
+    currentBlockNum = blockNum;
+}
+
+BlockScope::~BlockScope() {
+    currentBlockIdx = savedIdx_;
+    currentBlockNum = savedNum_;
+}
+
+}
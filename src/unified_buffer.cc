@@ -0,0 +1,66 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "unified_buffer.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+namespace asl {
+
+namespace {
+    std::size_t CapacityFromEnv() {
+        const char* env = std::getenv("ASL_UB_SIZE");
+        if (env == nullptr || *env == '\0') {
+            return UB_DEFAULT_CAPACITY;
+        }
+        char* end = nullptr;
+        unsigned long long bytes = std::strtoull(env, &end, 10);
+        return (end == env || bytes == 0) ? UB_DEFAULT_CAPACITY : static_cast<std::size_t>(bytes);
+    }
+
+    std::atomic<std::size_t>& CapacitySetting() {
+        static std::atomic<std::size_t> capacity{CapacityFromEnv()};
+        return capacity;
+    }
+}
+
+void UnifiedBuffer::SetCapacity(std::size_t bytes) {
+    CapacitySetting().store(bytes == 0 ? UB_DEFAULT_CAPACITY : bytes, std::memory_order_relaxed);
+}
+
+std::size_t UnifiedBuffer::Capacity() {
+    return CapacitySetting().load(std::memory_order_relaxed);
+}
+
+UnifiedBuffer& UnifiedBuffer::Current() {
+    thread_local UnifiedBuffer buffer;
+    std::size_t capacity = Capacity();
+    if (buffer.used_ == 0 && buffer.capacity_ != capacity) {
+        buffer.Reserve(capacity);
+    }
+    return buffer;
+}
+
+void UnifiedBuffer::Reserve(std::size_t capacity) {
+    storage_.assign(capacity + UB_ALIGN, 0);
+    auto begin = reinterpret_cast<std::uintptr_t>(storage_.data());
+    base_ = storage_.data() + (UbAlignUp(begin) - begin);
+    capacity_ = capacity;
+    peak_ = 0;
+}
+
+void* UnifiedBuffer::Allocate(std::size_t bytes) {
+    std::size_t aligned = UbAlignUp(bytes);
+    if (aligned > capacity_ - used_) {
+        throw UbOverflowError("unified buffer overflow: need " + std::to_string(aligned) + " bytes with " +
+                              std::to_string(used_) + " of " + std::to_string(capacity_) + " bytes in use");
+    }
+    void* addr = base_ + used_;
+    used_ += aligned;
+    peak_ = used_ > peak_ ? used_ : peak_;
+    return addr;
+}
+
+}
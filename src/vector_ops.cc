@@ -0,0 +1,324 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#include "vector_ops.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ASL_VECTOR_X86 1
+#endif
+
+namespace asl {
+
+namespace {
+    std::atomic<IsaVariant>& CurrentIsa() {
+        static std::atomic<IsaVariant> isa{DetectIsa()};
+        return isa;
+    }
+
+    // Cephes 的 expf：exp(x) = 2^n * exp(r)，r = x - n * ln2 在 [-ln2 / 2, ln2 / 2] 内用 5 阶多项式逼近
+    // 多项式只在 [EXP_LO, EXP_HI] 上求值：低于 EXP_LO（含 -inf）冲为 0，高于 EXP_HI 为 +inf，NaN 原样透传
+    constexpr float EXP_HI = 88.3762626647949f;
+    constexpr float EXP_LO = -87.3365447505531f;
+    constexpr float LOG2E = 1.44269504088896341f;
+    constexpr float LN2_HI = 0.693359375f;
+    constexpr float LN2_LO = -2.12194440e-4f;
+    constexpr float EXP_P0 = 1.9875691500e-4f;
+    constexpr float EXP_P1 = 1.3981999507e-3f;
+    constexpr float EXP_P2 = 8.3334519073e-3f;
+    constexpr float EXP_P3 = 4.1665795894e-2f;
+    constexpr float EXP_P4 = 1.6666665459e-1f;
+    constexpr float EXP_P5 = 5.0000001201e-1f;
+
+#ifdef ASL_VECTOR_X86
+    // 各指令集的实现用宏展开：lambda 不继承 target 属性，无法内联内建函数
+#define ASL_SIMD_BINARY_LOOP(WIDTH, LOAD, STORE, OP)                                \
+    for (; i + WIDTH <= count; i += WIDTH) {                                        \
+        STORE(dst + i, OP(LOAD(src0 + i), LOAD(src1 + i)));                         \
+    }
+
+#define ASL_SIMD_SCALAR_LOOP(WIDTH, LOAD, STORE, OP, VS)                            \
+    for (; i + WIDTH <= count; i += WIDTH) {                                        \
+        STORE(dst + i, OP(LOAD(src + i), VS));                                      \
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////
+    __attribute__((target("avx2,fma")))
+    __m256 ExpAvx2(__m256 input) {
+        __m256 lo = _mm256_set1_ps(EXP_LO);
+        __m256 hi = _mm256_set1_ps(EXP_HI);
+        __m256 x = _mm256_min_ps(_mm256_max_ps(input, lo), hi);
+        __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_HI), x);
+        r = _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_LO), r);
+        __m256 y = _mm256_set1_ps(EXP_P0);
+        y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(EXP_P1));
+        y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(EXP_P2));
+        y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(EXP_P3));
+        y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(EXP_P4));
+        y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(EXP_P5));
+        y = _mm256_fmadd_ps(y, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+        __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+        y = _mm256_mul_ps(y, _mm256_castsi256_ps(e));
+        y = _mm256_blendv_ps(y, _mm256_setzero_ps(), _mm256_cmp_ps(input, lo, _CMP_LT_OQ));
+        y = _mm256_blendv_ps(y, _mm256_set1_ps(std::numeric_limits<float>::infinity()),
+                             _mm256_cmp_ps(input, hi, _CMP_GT_OQ));
+        return _mm256_blendv_ps(y, input, _mm256_cmp_ps(input, input, _CMP_UNORD_Q));
+    }
+
+    __attribute__((target("avx2,fma")))
+    std::size_t BinaryAvx2(VectorBinary op, float* dst, const float* src0, const float* src1, std::size_t count) {
+        std::size_t i = 0;
+        switch (op) {
+        case VectorBinary::ADD: ASL_SIMD_BINARY_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps) break;
+        case VectorBinary::SUB: ASL_SIMD_BINARY_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_sub_ps) break;
+        case VectorBinary::MUL: ASL_SIMD_BINARY_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_mul_ps) break;
+        case VectorBinary::DIV: ASL_SIMD_BINARY_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_div_ps) break;
+        case VectorBinary::MAX: ASL_SIMD_BINARY_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_max_ps) break;
+        case VectorBinary::MIN: ASL_SIMD_BINARY_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_min_ps) break;
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2,fma")))
+    std::size_t ScalarAvx2(VectorScalar op, float* dst, const float* src, float scalar, std::size_t count) {
+        std::size_t i = 0;
+        __m256 vs = _mm256_set1_ps(scalar);
+        switch (op) {
+        case VectorScalar::ADDS: ASL_SIMD_SCALAR_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, vs) break;
+        case VectorScalar::MULS: ASL_SIMD_SCALAR_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_mul_ps, vs) break;
+        case VectorScalar::MAXS: ASL_SIMD_SCALAR_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_max_ps, vs) break;
+        case VectorScalar::MINS: ASL_SIMD_SCALAR_LOOP(8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_min_ps, vs) break;
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2,fma")))
+    std::size_t UnaryAvx2(VectorUnary op, float* dst, const float* src, std::size_t count) {
+        std::size_t i = 0;
+        __m256 zero = _mm256_setzero_ps();
+        __m256 sign = _mm256_set1_ps(-0.0f);
+        for (; i + 8 <= count; i += 8) {
+            __m256 x = _mm256_loadu_ps(src + i);
+            switch (op) {
+            case VectorUnary::EXP:  x = ExpAvx2(x); break;
+            case VectorUnary::ABS:  x = _mm256_andnot_ps(sign, x); break;
+            case VectorUnary::RELU: x = _mm256_max_ps(x, zero); break;
+            case VectorUnary::SQRT: x = _mm256_sqrt_ps(x); break;
+            }
+            _mm256_storeu_ps(dst + i, x);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2,fma")))
+    float ReduceSumAvx2(const float* src, std::size_t count, std::size_t& i) {
+        __m256 acc[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+        for (; i + 32 <= count; i += 32) {
+            acc[0] = _mm256_add_ps(acc[0], _mm256_loadu_ps(src + i));
+            acc[1] = _mm256_add_ps(acc[1], _mm256_loadu_ps(src + i + 8));
+            acc[2] = _mm256_add_ps(acc[2], _mm256_loadu_ps(src + i + 16));
+            acc[3] = _mm256_add_ps(acc[3], _mm256_loadu_ps(src + i + 24));
+        }
+        for (; i + 8 <= count; i += 8) {
+            acc[0] = _mm256_add_ps(acc[0], _mm256_loadu_ps(src + i));
+        }
+        __m256 sum = _mm256_add_ps(_mm256_add_ps(acc[0], acc[1]), _mm256_add_ps(acc[2], acc[3]));
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_movehdup_ps(half));
+        return _mm_cvtss_f32(half);
+    }
+
+    __attribute__((target("avx2,fma")))
+    float ReduceMaxAvx2(const float* src, std::size_t count, std::size_t& i) {
+        __m256 best = _mm256_loadu_ps(src);
+        for (i = 8; i + 8 <= count; i += 8) {
+            best = _mm256_max_ps(best, _mm256_loadu_ps(src + i));
+        }
+        __m128 half = _mm_max_ps(_mm256_castps256_ps128(best), _mm256_extractf128_ps(best, 1));
+        half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_max_ss(half, _mm_movehdup_ps(half));
+        return _mm_cvtss_f32(half);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////
+    __attribute__((target("avx512f")))
+    __m512 ExpAvx512(__m512 input) {
+        __m512 lo = _mm512_set1_ps(EXP_LO);
+        __m512 hi = _mm512_set1_ps(EXP_HI);
+        __m512 x = _mm512_min_ps(_mm512_max_ps(input, lo), hi);
+        __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(LN2_HI), x);
+        r = _mm512_fnmadd_ps(n, _mm512_set1_ps(LN2_LO), r);
+        __m512 y = _mm512_set1_ps(EXP_P0);
+        y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(EXP_P1));
+        y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(EXP_P2));
+        y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(EXP_P3));
+        y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(EXP_P4));
+        y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(EXP_P5));
+        y = _mm512_fmadd_ps(y, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+        __m512i e = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23);
+        y = _mm512_mul_ps(y, _mm512_castsi512_ps(e));
+        y = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(input, lo, _CMP_LT_OQ), y, _mm512_setzero_ps());
+        y = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(input, hi, _CMP_GT_OQ), y,
+                                 _mm512_set1_ps(std::numeric_limits<float>::infinity()));
+        return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(input, input, _CMP_UNORD_Q), y, input);
+    }
+
+    __attribute__((target("avx512f")))
+    std::size_t BinaryAvx512(VectorBinary op, float* dst, const float* src0, const float* src1, std::size_t count) {
+        std::size_t i = 0;
+        switch (op) {
+        case VectorBinary::ADD: ASL_SIMD_BINARY_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps) break;
+        case VectorBinary::SUB: ASL_SIMD_BINARY_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_sub_ps) break;
+        case VectorBinary::MUL: ASL_SIMD_BINARY_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_mul_ps) break;
+        case VectorBinary::DIV: ASL_SIMD_BINARY_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_div_ps) break;
+        case VectorBinary::MAX: ASL_SIMD_BINARY_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_max_ps) break;
+        case VectorBinary::MIN: ASL_SIMD_BINARY_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_min_ps) break;
+        }
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    std::size_t ScalarAvx512(VectorScalar op, float* dst, const float* src, float scalar, std::size_t count) {
+        std::size_t i = 0;
+        __m512 vs = _mm512_set1_ps(scalar);
+        switch (op) {
+        case VectorScalar::ADDS: ASL_SIMD_SCALAR_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps, vs) break;
+        case VectorScalar::MULS: ASL_SIMD_SCALAR_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_mul_ps, vs) break;
+        case VectorScalar::MAXS: ASL_SIMD_SCALAR_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_max_ps, vs) break;
+        case VectorScalar::MINS: ASL_SIMD_SCALAR_LOOP(16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_min_ps, vs) break;
+        }
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    std::size_t UnaryAvx512(VectorUnary op, float* dst, const float* src, std::size_t count) {
+        std::size_t i = 0;
+        __m512 zero = _mm512_setzero_ps();
+        __m512i mask = _mm512_set1_epi32(0x7fffffff);
+        for (; i + 16 <= count; i += 16) {
+            __m512 x = _mm512_loadu_ps(src + i);
+            switch (op) {
+            case VectorUnary::EXP:  x = ExpAvx512(x); break;
+            case VectorUnary::ABS:  x = _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(x), mask)); break;
+            case VectorUnary::RELU: x = _mm512_max_ps(x, zero); break;
+            case VectorUnary::SQRT: x = _mm512_sqrt_ps(x); break;
+            }
+            _mm512_storeu_ps(dst + i, x);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    float ReduceSumAvx512(const float* src, std::size_t count, std::size_t& i) {
+        __m512 acc[4] = {_mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps()};
+        for (; i + 64 <= count; i += 64) {
+            acc[0] = _mm512_add_ps(acc[0], _mm512_loadu_ps(src + i));
+            acc[1] = _mm512_add_ps(acc[1], _mm512_loadu_ps(src + i + 16));
+            acc[2] = _mm512_add_ps(acc[2], _mm512_loadu_ps(src + i + 32));
+            acc[3] = _mm512_add_ps(acc[3], _mm512_loadu_ps(src + i + 48));
+        }
+        for (; i + 16 <= count; i += 16) {
+            acc[0] = _mm512_add_ps(acc[0], _mm512_loadu_ps(src + i));
+        }
+        return _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(acc[0], acc[1]), _mm512_add_ps(acc[2], acc[3])));
+    }
+
+    __attribute__((target("avx512f")))
+    float ReduceMaxAvx512(const float* src, std::size_t count, std::size_t& i) {
+        __m512 best = _mm512_loadu_ps(src);
+        for (i = 16; i + 16 <= count; i += 16) {
+            best = _mm512_max_ps(best, _mm512_loadu_ps(src + i));
+        }
+        return _mm512_reduce_max_ps(best);
+    }
+
+#undef ASL_SIMD_BINARY_LOOP
+#undef ASL_SIMD_SCALAR_LOOP
+#endif
+}
+
+IsaVariant VectorIsa() {
+    return CurrentIsa().load(std::memory_order_relaxed);
+}
+
+void SetVectorIsa(IsaVariant isa) {
+    CurrentIsa().store(std::min(isa, DetectIsa()), std::memory_order_relaxed);
+}
+
+// 各指令集的实现处理完整的向量宽度，剩余的尾部元素由标量循环完成
+void VectorBinaryF32(VectorBinary op, float* dst, const float* src0, const float* src1, std::size_t count) {
+    std::size_t done = 0;
+#ifdef ASL_VECTOR_X86
+    switch (VectorIsa()) {
+    case IsaVariant::AVX512: done = BinaryAvx512(op, dst, src0, src1, count); break;
+    case IsaVariant::AVX2:   done = BinaryAvx2(op, dst, src0, src1, count); break;
+    default: break;
+    }
+#endif
+    detail::BinaryScalarLoop(op, dst + done, src0 + done, src1 + done, count - done);
+}
+
+void VectorScalarF32(VectorScalar op, float* dst, const float* src, float scalar, std::size_t count) {
+    std::size_t done = 0;
+#ifdef ASL_VECTOR_X86
+    switch (VectorIsa()) {
+    case IsaVariant::AVX512: done = ScalarAvx512(op, dst, src, scalar, count); break;
+    case IsaVariant::AVX2:   done = ScalarAvx2(op, dst, src, scalar, count); break;
+    default: break;
+    }
+#endif
+    detail::ScalarScalarLoop(op, dst + done, src + done, scalar, count - done);
+}
+
+void VectorUnaryF32(VectorUnary op, float* dst, const float* src, std::size_t count) {
+    std::size_t done = 0;
+#ifdef ASL_VECTOR_X86
+    switch (VectorIsa()) {
+    case IsaVariant::AVX512: done = UnaryAvx512(op, dst, src, count); break;
+    case IsaVariant::AVX2:   done = UnaryAvx2(op, dst, src, count); break;
+    default: break;
+    }
+#endif
+    detail::UnaryScalarLoop(op, dst + done, src + done, count - done);
+}
+
+float VectorReduceSumF32(const float* src, std::size_t count) {
+    std::size_t i = 0;
+    float sum = 0.0f;
+#ifdef ASL_VECTOR_X86
+    switch (VectorIsa()) {
+    case IsaVariant::AVX512: sum = ReduceSumAvx512(src, count, i); break;
+    case IsaVariant::AVX2:   sum = ReduceSumAvx2(src, count, i); break;
+    default: break;
+    }
+#endif
+    for (; i < count; ++i) {
+        sum += src[i];
+    }
+    return sum;
+}
+
+float VectorReduceMaxF32(const float* src, std::size_t count) {
+    std::size_t i = 0;
+    float best = -std::numeric_limits<float>::infinity();
+#ifdef ASL_VECTOR_X86
+    if (VectorIsa() == IsaVariant::AVX512 && count >= 16) {
+        best = ReduceMaxAvx512(src, count, i);
+    } else if (VectorIsa() != IsaVariant::SCALAR && count >= 8) {
+        best = ReduceMaxAvx2(src, count, i);
+    }
+#endif
+    for (; i < count; ++i) {
+        best = best < src[i] ? src[i] : best;
+    }
+    return best;
+}
+
+}
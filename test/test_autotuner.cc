@@ -0,0 +1,105 @@
+#include "catch2/catch.hpp"
+#include "autotuner.h"
+#include "kernel_ops.h"
+#include "thread_pool.h"
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    // 记录每次 OP 调用的元素数，用于检查启动时实际采用的 tile 划分
+    struct OpRecordTiles {
+        static std::vector<std::size_t>& Tiles() {
+            static std::vector<std::size_t> tiles;
+            return tiles;
+        }
+
+        void operator()(Tensor<int> x, Tensor<int> y, std::size_t cnt) const {
+            for (std::size_t i = 0; i < cnt; ++i) {
+                y.data[i] = x.data[i] + 1;
+            }
+            static std::mutex mutex;
+            std::lock_guard<std::mutex> lock(mutex);
+            Tiles().push_back(cnt);
+        }
+    };
+
+    using RecordTilesKernel = ElemWise<OpRecordTiles, Input<int>, Output<int>>;
+}
+
+SCENARIO("Test autotuner count buckets") {
+    REQUIRE(Autotuner::CountBucket(0) == 0);
+    REQUIRE(Autotuner::CountBucket(1) == 0);
+    REQUIRE(Autotuner::CountBucket(1023) == 9);
+    REQUIRE(Autotuner::CountBucket(1024) == 10);
+    REQUIRE(Autotuner::CountBucket(2047) == 10);
+}
+
+SCENARIO("Test elem wise runs tiles inside block") {
+    std::vector<int> inputs(1000, 1);
+    std::vector<int> outputs(1000, 0);
+    RecordTilesKernel kernel;
+    OpRecordTiles::Tiles().clear();
+    kernel.RunWithConfig(LaunchConfig{nullptr, 1, LaunchSchedule::STATIC, 300},
+                         reinterpret_cast<Addr>(inputs.data()), reinterpret_cast<Addr>(outputs.data()), 1000);
+    REQUIRE(OpRecordTiles::Tiles() == std::vector<std::size_t>{300, 300, 300, 100});
+    REQUIRE(outputs[999] == 2);
+}
+
+SCENARIO("Test autotuner tunes and applies winners at launch") {
+    ThreadPool pool(2);
+    Autotuner& tuner = Autotuner::Default();
+    tuner.Clear();
+
+    TuneCandidates candidates;
+    candidates.blockDims = {1, 2};
+    candidates.tileSizes = {0, 128};
+    candidates.repeat = 1;
+    TunedConfig best = tuner.Tune<RecordTilesKernel>(pool, 4096, candidates);
+    REQUIRE((best.blockDim == 1 || best.blockDim == 2));
+    REQUIRE((best.tileSize == 0 || best.tileSize == 128));
+    REQUIRE(tuner.Size() == 1);
+
+    // 用固定的调优结果检查启动时的查表
+    tuner.Set(RecordTilesKernel::Signature(), Autotuner::CountBucket(4096), TunedConfig{2, 512, 0.0});
+    std::vector<int> inputs(4096, 5);
+    std::vector<int> outputs(4096, 0);
+    RecordTilesKernel kernel;
+    OpRecordTiles::Tiles().clear();
+    kernel.RunAuto(pool, reinterpret_cast<Addr>(inputs.data()), reinterpret_cast<Addr>(outputs.data()), 4096);
+    REQUIRE(OpRecordTiles::Tiles() == std::vector<std::size_t>(8, 512));
+    REQUIRE(outputs[4095] == 6);
+
+    // 其他档位未调优时每个线程一个 block
+    OpRecordTiles::Tiles().clear();
+    kernel.RunAuto(pool, reinterpret_cast<Addr>(inputs.data()), reinterpret_cast<Addr>(outputs.data()), 100);
+    REQUIRE(OpRecordTiles::Tiles().size() == 2);
+
+    tuner.Clear();
+}
+
+SCENARIO("Test autotuner persists winners") {
+    Autotuner tuner;
+    tuner.Set("kernelA", 10, TunedConfig{4, 4096, 0.25});
+    tuner.Set("kernelA", 20, TunedConfig{8, 0, 1.5});
+    tuner.Set("kernelB", 12, TunedConfig{2, 16384, 0.125});
+
+    std::string path = "/tmp/asl_autotune_test.bin";
+    REQUIRE(tuner.Save(path));
+
+    Autotuner loaded;
+    REQUIRE(loaded.Load(path));
+    REQUIRE(loaded.Size() == 3);
+    TunedConfig config;
+    REQUIRE(loaded.Find("kernelA", 1 << 20, config));
+    REQUIRE(config.blockDim == 8);
+    REQUIRE(config.tileSize == 0);
+    REQUIRE(loaded.Find("kernelB", 5000, config));
+    REQUIRE(config.tileSize == 16384);
+    REQUIRE_FALSE(loaded.Find("kernelB", 100, config));
+    REQUIRE_FALSE(loaded.Load("/tmp/asl_autotune_missing.bin"));
+    std::remove(path.c_str());
+}
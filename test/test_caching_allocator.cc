@@ -0,0 +1,126 @@
+#include "catch2/catch.hpp"
+#include "caching_allocator.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+SCENARIO("Test caching allocator bucket sizes") {
+    CachingAllocator pow2;
+    REQUIRE(pow2.BucketSize(1) == 64);
+    REQUIRE(pow2.BucketSize(64) == 64);
+    REQUIRE(pow2.BucketSize(65) == 128);
+    REQUIRE(pow2.BucketSize(3000) == 4096);
+
+    CachingAllocatorConfig config;
+    config.policy = BucketPolicy::GEOMETRIC_1_25;
+    CachingAllocator geometric(config);
+    REQUIRE(geometric.BucketSize(3000) < 4096);
+    REQUIRE(geometric.BucketSize(3000) >= 3000);
+    REQUIRE(geometric.BucketSize(3000) % CachingAllocator::ALIGNMENT == 0);
+}
+
+SCENARIO("Test caching allocator reuses freed blocks") {
+    CachingAllocator allocator;
+
+    Addr first = allocator.Allocate(1000);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(first) % CachingAllocator::ALIGNMENT == 0);
+    REQUIRE(allocator.Stats().misses == 1);
+    REQUIRE(allocator.Stats().bytesInUse == 1024);
+    REQUIRE(allocator.Stats().bytesRequested == 1000);
+    REQUIRE(allocator.Stats().Fragmentation() == Approx(1.0 - 1000.0 / 1024.0));
+
+    allocator.Free(first);
+    REQUIRE(allocator.Stats().bytesCached == 1024);
+    REQUIRE(allocator.Stats().bytesInUse == 0);
+
+    Addr second = allocator.Allocate(900);
+    REQUIRE(second == first);
+    REQUIRE(allocator.Stats().hits == 1);
+    REQUIRE(allocator.Stats().bytesCached == 0);
+    allocator.Free(second);
+
+    allocator.ReleaseCached();
+    REQUIRE(allocator.Stats().bytesCached == 0);
+}
+
+SCENARIO("Test caching allocator shares blocks across threads through global cache") {
+    CachingAllocatorConfig config;
+    config.threadCacheBlocks = 0;
+    CachingAllocator allocator(config);
+
+    Addr addr = allocator.Allocate(4096);
+    std::thread([&allocator, addr]() { allocator.Free(addr); }).join();
+    REQUIRE(allocator.Stats().bytesCached == 4096);
+
+    Addr reused = allocator.Allocate(4096);
+    REQUIRE(reused == addr);
+    REQUIRE(allocator.Stats().hits == 1);
+    allocator.Free(reused);
+}
+
+SCENARIO("Test caching allocator flushes thread cache on thread exit") {
+    CachingAllocator allocator;
+
+    std::thread([&allocator]() {
+        Addr addr = allocator.Allocate(256);
+        allocator.Free(addr);
+    }).join();
+    REQUIRE(allocator.Stats().bytesCached == 256);
+
+    Addr addr = allocator.Allocate(256);
+    REQUIRE(allocator.Stats().hits == 1);
+    allocator.Free(addr);
+}
+
+SCENARIO("Test caching allocator with buffer") {
+    CachingAllocator allocator;
+    {
+        CachedBuffer buffer = AllocateBuffer(128, allocator);
+        buffer[0] = 1;
+        buffer[127] = 2;
+        REQUIRE(allocator.Stats().bytesInUse == 128);
+    }
+    REQUIRE(allocator.Stats().bytesInUse == 0);
+    REQUIRE(allocator.Stats().bytesCached == 128);
+}
+
+SCENARIO("Test caching allocator thread cache respects byte cap") {
+    CachingAllocatorConfig config;
+    config.maxCachedBytes = 1024;
+    CachingAllocator allocator(config);
+
+    Addr blocks[4];
+    for (auto& block : blocks) {
+        block = allocator.Allocate(512);
+    }
+    for (auto& block : blocks) {
+        allocator.Free(block);
+    }
+    REQUIRE(allocator.Stats().bytesCached == 1024);
+}
+
+SCENARIO("Test caching allocator releases other threads' caches") {
+    CachingAllocator allocator;
+    std::atomic<int> step{0};
+
+    std::thread worker([&allocator, &step]() {
+        allocator.Free(allocator.Allocate(256));
+        step = 1;
+        while (step.load() != 2) {
+            std::this_thread::yield();
+        }
+        // 下次访问分配器时归还 ReleaseCached 之前缓存的块
+        allocator.Free(allocator.Allocate(64));
+    });
+    while (step.load() != 1) {
+        std::this_thread::yield();
+    }
+    REQUIRE(allocator.Stats().bytesCached == 256);
+    allocator.ReleaseCached();
+    step = 2;
+    worker.join();
+    REQUIRE(allocator.Stats().bytesCached == 64);
+}
@@ -0,0 +1,74 @@
+#include "catch2/catch.hpp"
+#include "chase_lev_deque.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+SCENARIO("Test chase lev deque pop lifo and steal fifo") {
+    ChaseLevDeque<int> deque(4);
+    for (int i = 0; i < 10; ++i) {
+        deque.Push(i);
+    }
+    REQUIRE(deque.Size() == 10);
+
+    int value = -1;
+    REQUIRE(deque.Pop(value));
+    REQUIRE(value == 9);
+    REQUIRE(deque.Steal(value));
+    REQUIRE(value == 0);
+    REQUIRE(deque.Steal(value));
+    REQUIRE(value == 1);
+
+    std::vector<int> rest;
+    while (deque.Pop(value)) {
+        rest.push_back(value);
+    }
+    REQUIRE(rest == std::vector<int>{8, 7, 6, 5, 4, 3, 2});
+    REQUIRE_FALSE(deque.Steal(value));
+    REQUIRE(deque.Size() == 0);
+}
+
+SCENARIO("Test chase lev deque every item taken once under concurrent steals") {
+    constexpr int ITEMS = 20000;
+    constexpr int THIEVES = 3;
+    ChaseLevDeque<int> deque(8);
+    std::vector<std::atomic<int>> taken(ITEMS);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < THIEVES; ++t) {
+        thieves.emplace_back([&]() {
+            int value = 0;
+            while (!done.load()) {
+                if (deque.Steal(value)) {
+                    taken[value].fetch_add(1);
+                }
+            }
+        });
+    }
+
+    int value = 0;
+    for (int i = 0; i < ITEMS; ++i) {
+        deque.Push(i);
+        if (i % 3 == 0 && deque.Pop(value)) {
+            taken[value].fetch_add(1);
+        }
+    }
+    while (deque.Pop(value)) {
+        taken[value].fetch_add(1);
+    }
+    done = true;
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+
+    int total = 0;
+    for (auto& count : taken) {
+        REQUIRE(count.load() == 1);
+        total += count.load();
+    }
+    REQUIRE(total == ITEMS);
+}
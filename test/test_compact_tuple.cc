@@ -0,0 +1,37 @@
+#include "catch2/catch.hpp"
+#include "compact_tuple.h"
+#include <type_traits>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+SCENARIO("Test compact tuple reorders storage by alignment") {
+    using Layout = CompactLayout<char, double, char, int>;
+
+    static_assert(Layout::ORDER.toLogical[0] == 1, "double should be stored first");
+    static_assert(Layout::ORDER.toLogical[1] == 3, "int should be stored second");
+    static_assert(Layout::ORDER.toLogical[2] == 0, "first char keeps its relative order");
+    static_assert(Layout::ORDER.toLogical[3] == 2, "second char keeps its relative order");
+
+    static_assert(std::is_same_v<CompactTuple<char, double, char, int>::Storage,
+                                 Tuple<double, int, char, char>>, "storage should be sorted by alignment");
+    static_assert(sizeof(CompactTuple<char, double, char, int>) == 16, "compact tuple should only pad to 16 bytes");
+    static_assert(sizeof(CompactTuple<char, double, char, int>) < sizeof(Tuple<char, double, char, int>),
+                  "compact tuple should be smaller than tuple");
+    static_assert(TupleSize<CompactTuple<char, double, char, int>>::value == 4, "size should be 4");
+    static_assert(std::is_same_v<TupleElemType<1, CompactTuple<char, double, char, int>>::type, double>,
+                  "logical element 1 should be double");
+}
+
+SCENARIO("Test compact tuple keeps logical indices") {
+    CompactTuple<char, double, char, int> tuple('a', 1.5, 'b', 7);
+
+    REQUIRE(TupleElemGet<0>(tuple) == 'a');
+    REQUIRE(TupleElemGet<1>(tuple) == 1.5);
+    REQUIRE(TupleElemGet<2>(tuple) == 'b');
+    REQUIRE(TupleElemGet<3>(tuple) == 7);
+
+    TupleElemGet<3>(tuple) = 9;
+    REQUIRE(TupleElemGet<3>(tuple) == 9);
+    REQUIRE(TupleElemGet<1>(tuple.storage) == 9);
+}
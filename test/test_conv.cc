@@ -0,0 +1,155 @@
+#include "catch2/catch.hpp"
+#include "autotuner.h"
+#include "conv.h"
+#include "simulator.h"
+#include "thread_pool.h"
+#include "vector_ops.h"
+#include "test_util.h"
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    // 按定义逐点计算的直接卷积
+    template <typename T>
+    std::vector<T> NaiveConv(const std::vector<T>& x, const std::vector<T>& w, const Conv2dShape& shape) {
+        const std::size_t outH = shape.OutH();
+        const std::size_t outW = shape.OutW();
+        std::vector<T> y(shape.OutputSize());
+        bool nchw = shape.layout == ConvLayout::NCHW;
+        for (std::size_t n = 0; n < shape.batch; ++n)
+        for (std::size_t oc = 0; oc < shape.outChannels; ++oc)
+        for (std::size_t oh = 0; oh < outH; ++oh)
+        for (std::size_t ow = 0; ow < outW; ++ow) {
+            T sum = T(0);
+            for (std::size_t ic = 0; ic < shape.inChannels; ++ic)
+            for (std::size_t kh = 0; kh < shape.kernelH; ++kh)
+            for (std::size_t kw = 0; kw < shape.kernelW; ++kw) {
+                long ih = static_cast<long>(oh * shape.strideH + kh * shape.dilationH) - static_cast<long>(shape.padH);
+                long iw = static_cast<long>(ow * shape.strideW + kw * shape.dilationW) - static_cast<long>(shape.padW);
+                if (ih < 0 || iw < 0 || ih >= static_cast<long>(shape.height) || iw >= static_cast<long>(shape.width)) {
+                    continue;
+                }
+                std::size_t xi = nchw ? ((n * shape.inChannels + ic) * shape.height + ih) * shape.width + iw
+                                      : ((n * shape.height + ih) * shape.width + iw) * shape.inChannels + ic;
+                std::size_t wi = nchw ? ((oc * shape.inChannels + ic) * shape.kernelH + kh) * shape.kernelW + kw
+                                      : ((kh * shape.kernelW + kw) * shape.inChannels + ic) * shape.outChannels + oc;
+                sum += x[xi] * w[wi];
+            }
+            std::size_t yi = nchw ? ((n * shape.outChannels + oc) * outH + oh) * outW + ow
+                                  : ((n * outH + oh) * outW + ow) * shape.outChannels + oc;
+            y[yi] = sum;
+        }
+        return y;
+    }
+
+    template <typename T>
+    std::vector<T> Sequence(std::size_t size, int mod) {
+        std::vector<T> values(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            values[i] = static_cast<T>(static_cast<int>(i * 7 % mod) - mod / 2);
+        }
+        return values;
+    }
+}
+
+SCENARIO("Test conv2d shape") {
+    Conv2dShape shape{2, 3, 17, 12, 5, 3, 3};
+    REQUIRE(shape.OutH() == 15);
+    REQUIRE(shape.OutW() == 10);
+
+    shape.strideH = 2;
+    shape.padW = 1;
+    shape.dilationW = 2;
+    REQUIRE(shape.OutH() == 8);
+    REQUIRE(shape.OutW() == 10);
+    REQUIRE(shape.OutputSize() == 2 * 5 * 8 * 10);
+
+    // 卷积核大于填充后的输入时没有输出
+    Conv2dShape empty{1, 1, 2, 2, 1, 5, 5};
+    REQUIRE(empty.OutH() == 0);
+}
+
+SCENARIO("Test conv2d matches direct convolution on every isa") {
+    auto isa = GENERATE(IsaVariant::SCALAR, IsaVariant::AVX2, IsaVariant::AVX512);
+    IsaGuard guard(isa);
+
+    // 小分块使 K 跨多个 kc 面板且面板起点落在 (ic, kh, kw) 的中间；整数值保证 float 结果精确
+    Conv2dShape shape{2, 5, 13, 11, 7, 3, 3};
+    shape.layout = GENERATE(ConvLayout::NCHW, ConvLayout::NHWC);
+    auto stride = GENERATE(std::size_t(1), std::size_t(2));
+    auto pad = GENERATE(std::size_t(0), std::size_t(1), std::size_t(2));
+    auto dilation = GENERATE(std::size_t(1), std::size_t(2));
+    shape.strideH = stride;
+    shape.strideW = 3 - stride;
+    shape.padH = pad;
+    shape.padW = pad / 2;
+    shape.dilationH = dilation;
+    shape.dilationW = dilation;
+
+    std::vector<float> x = Sequence<float>(shape.InputSize(), 9);
+    std::vector<float> w = Sequence<float>(shape.WeightSize(), 5);
+    std::vector<float> y(shape.OutputSize(), 1234.0f);
+    std::vector<float> expected = NaiveConv(x, w, shape);
+
+    Conv2d<float> conv(MatmulBlocking{16, 13, 24});
+    conv.Run(AddrOf(x), AddrOf(w), AddrOf(y), shape);
+    REQUIRE(y == expected);
+}
+
+SCENARIO("Test conv2d on thread pool") {
+    ThreadPool pool(3);
+    Conv2dShape shape{3, 8, 20, 18, 16, 3, 5};
+    shape.padH = 1;
+    shape.padW = 2;
+    shape.layout = GENERATE(ConvLayout::NCHW, ConvLayout::NHWC);
+    auto schedule = GENERATE(LaunchSchedule::STATIC, LaunchSchedule::STEALING);
+
+    std::vector<double> x = Sequence<double>(shape.InputSize(), 11);
+    std::vector<double> w = Sequence<double>(shape.WeightSize(), 7);
+    std::vector<double> y(shape.OutputSize());
+    std::vector<double> expected = NaiveConv(x, w, shape);
+
+    Conv2d<double> conv(MatmulBlocking{24, 32, 64});
+    conv.RunWithConfig(LaunchConfig{&pool, AUTO_BLOCK_DIM, schedule}, AddrOf(x), AddrOf(w), AddrOf(y), shape);
+    REQUIRE(y == expected);
+}
+
+SCENARIO("Test conv2d 1x1 equals matmul") {
+    // 1x1、步长 1、无填充的 NHWC 卷积就是 (N*H*W x IC) * (IC x OC)
+    Conv2dShape shape{2, 19, 6, 7, 23, 1, 1};
+    shape.layout = ConvLayout::NHWC;
+    std::vector<float> x = Sequence<float>(shape.InputSize(), 9);
+    std::vector<float> w = Sequence<float>(shape.WeightSize(), 5);
+    std::vector<float> y(shape.OutputSize());
+    std::vector<float> expected(shape.OutputSize());
+
+    Conv2d<float>().Run(AddrOf(x), AddrOf(w), AddrOf(y), shape);
+    Matmul<float>().Run(AddrOf(x), AddrOf(w), AddrOf(expected), MatmulShape{2 * 6 * 7, 23, 19});
+    REQUIRE(y == expected);
+}
+
+SCENARIO("Test conv2d resolves tuned launch configs") {
+    ThreadPool pool(2);
+    Autotuner& tuner = Autotuner::Default();
+    tuner.Clear();
+    Conv2dShape shape{2, 5, 13, 11, 7, 3, 3};
+    std::vector<float> x = Sequence<float>(shape.InputSize(), 9);
+    std::vector<float> w = Sequence<float>(shape.WeightSize(), 5);
+    std::vector<float> y(shape.OutputSize());
+    tuner.Set(Conv2d<float>::Signature(), Autotuner::CountBucket(shape.OutputSize()), TunedConfig{3, 0, 0.0});
+
+    Simulator::Clear();
+    Simulator::Enable();
+    Conv2d<float>(MatmulBlocking{16, 13, 24}).RunParallel(pool, AUTO_BLOCK_DIM, AddrOf(x), AddrOf(w), AddrOf(y), shape);
+    Simulator::Enable(false);
+    tuner.Clear();
+
+    REQUIRE(y == NaiveConv(x, w, shape));
+    auto records = Simulator::Records();
+    REQUIRE(records.size() == 1);
+    REQUIRE(records[0].count == shape.OutputSize());
+    REQUIRE(records[0].blockDim == 3);
+    Simulator::Clear();
+}
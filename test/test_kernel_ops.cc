@@ -0,0 +1,134 @@
+#include "catch2/catch.hpp"
+#include "kernel_ops.h"
+#include "huge_page.h"
+#include "thread_pool.h"
+#include <cstdint>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 输入按 SoA 方式打包在同一块内存中：前 count 个为 x，后 count 个为 y
+template <typename OP, typename T>
+std::vector<T> RunBinary(const std::vector<T>& x, const std::vector<T>& y) {
+    std::size_t count = x.size();
+    std::vector<T> inputs(x);
+    inputs.insert(inputs.end(), y.begin(), y.end());
+    std::vector<T> output(count);
+
+    Addr in  = reinterpret_cast<Addr>(inputs.data());
+    Addr out = reinterpret_cast<Addr>(output.data());
+
+    BinaryElemWise<OP, T> kernel;
+    kernel.Run(in, in, out, count);
+    return output;
+}
+
+SCENARIO("Test prebuilt binary elem wise kernels") {
+    std::vector<float> x{1.0f, 2.0f, 3.0f, 4.0f};
+    std::vector<float> y{4.0f, 3.0f, 2.0f, 1.0f};
+
+    REQUIRE(RunBinary<OpAdd>(x, y) == std::vector<float>{5.0f, 5.0f, 5.0f, 5.0f});
+    REQUIRE(RunBinary<OpSub>(x, y) == std::vector<float>{-3.0f, -1.0f, 1.0f, 3.0f});
+    REQUIRE(RunBinary<OpMul>(x, y) == std::vector<float>{4.0f, 6.0f, 6.0f, 4.0f});
+    REQUIRE(RunBinary<OpDiv>(x, y) == std::vector<float>{0.25f, 2.0f / 3.0f, 1.5f, 4.0f});
+    REQUIRE(RunBinary<OpMax>(x, y) == std::vector<float>{4.0f, 3.0f, 3.0f, 4.0f});
+    REQUIRE(RunBinary<OpMin>(x, y) == std::vector<float>{1.0f, 2.0f, 2.0f, 1.0f});
+
+    std::vector<int64_t> a{10, -20, 30};
+    std::vector<int64_t> b{3, 4, -5};
+    REQUIRE(RunBinary<OpAdd>(a, b) == std::vector<int64_t>{13, -16, 25});
+    REQUIRE(RunBinary<OpDiv>(a, b) == std::vector<int64_t>{3, -5, -6});
+}
+
+SCENARIO("Test binary elem wise kernel not prebuilt") {
+    std::vector<int16_t> x{1, 2, 3};
+    std::vector<int16_t> y{3, 2, 1};
+    REQUIRE(RunBinary<OpMul>(x, y) == std::vector<int16_t>{3, 4, 3});
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+SCENARIO("Test block partition covers all elements") {
+    std::size_t total = 1000;
+    std::size_t covered = 0;
+    for (std::size_t b = 0; b < 3; ++b) {
+        BlockRange range = BlockPartition(total, 3, b);
+        REQUIRE(range.offset == covered);
+        REQUIRE((range.offset % BLOCK_ALIGN == 0 || range.count == 0));
+        covered += range.count;
+    }
+    REQUIRE(covered == total);
+
+    REQUIRE(BlockPartition(10, 4, 3).count == 0);
+    REQUIRE(BlockPartition(10, 4, 0).count == 10);
+}
+
+SCENARIO("Test binary elem wise kernel run on multiple blocks") {
+    ThreadPool pool(4);
+    std::size_t count = 10007;
+    std::vector<float> inputs(count * 2);
+    std::vector<float> output(count, -1.0f);
+    for (std::size_t i = 0; i < count; ++i) {
+        inputs[i] = static_cast<float>(i);
+        inputs[count + i] = 1.0f;
+    }
+
+    Addr in  = reinterpret_cast<Addr>(inputs.data());
+    Addr out = reinterpret_cast<Addr>(output.data());
+
+    BinaryElemWise<OpAdd, float> kernel;
+    kernel.RunParallel(pool, 6, in, in, out, count);
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(output[i] == static_cast<float>(i) + 1.0f);
+    }
+}
+
+SCENARIO("Test binary elem wise kernel run with work stealing") {
+    ThreadPool pool(3);
+    std::size_t count = 50021;
+    std::vector<std::int32_t> inputs(count * 2);
+    std::vector<std::int32_t> output(count, -1);
+    for (std::size_t i = 0; i < count; ++i) {
+        inputs[i] = static_cast<std::int32_t>(i);
+        inputs[count + i] = 3;
+    }
+
+    Addr in  = reinterpret_cast<Addr>(inputs.data());
+    Addr out = reinterpret_cast<Addr>(output.data());
+
+    BinaryElemWise<OpMul, std::int32_t> kernel;
+    kernel.RunStealing(pool, 4, in, in, out, count);
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(output[i] == static_cast<std::int32_t>(i) * 3);
+    }
+
+    std::vector<std::int32_t> small(10);
+    kernel.RunStealing(pool, 4, in, in, reinterpret_cast<Addr>(small.data()), 5);
+    REQUIRE(small[4] == inputs[4] * inputs[5 + 4]);
+}
+
+SCENARIO("Test first touch huge page tensors by block workers") {
+    ThreadPool pool(2);
+    std::size_t count = 1 << 20;
+    HugePageBuffer inputs(count * 2 * sizeof(double), HugePagePolicy::TRANSPARENT);
+    HugePageBuffer output(count * sizeof(double));
+    REQUIRE(inputs.Size() % HUGE_PAGE_SIZE == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(inputs.Data()) % HUGE_PAGE_SIZE == 0);
+
+    BinaryElemWise<OpMul, double> kernel;
+    kernel.FirstTouch(pool, 4, inputs.Data(), inputs.Data(), output.Data(), count);
+
+    auto* xs = reinterpret_cast<double*>(inputs.Data());
+    REQUIRE(xs[0] == 0.0);
+    REQUIRE(xs[count * 2 - 1] == 0.0);
+    for (std::size_t i = 0; i < count; ++i) {
+        xs[i] = 2.0;
+        xs[count + i] = static_cast<double>(i);
+    }
+
+    kernel.RunParallel(pool, 4, inputs.Data(), inputs.Data(), output.Data(), count);
+    auto* zs = reinterpret_cast<double*>(output.Data());
+    REQUIRE(zs[0] == 0.0);
+    REQUIRE(zs[12345] == 24690.0);
+    REQUIRE(zs[count - 1] == 2.0 * (count - 1));
+}
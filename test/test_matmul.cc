@@ -0,0 +1,198 @@
+#include "catch2/catch.hpp"
+#include "autotuner.h"
+#include "matmul.h"
+#include "simulator.h"
+#include "thread_pool.h"
+#include "vector_ops.h"
+#include "test_util.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    template <typename T>
+    std::vector<T> NaiveMatmul(const std::vector<T>& a, const std::vector<T>& b, const std::vector<T>& c,
+                               const MatmulShape& shape, T beta) {
+        std::vector<T> result(shape.m * shape.n);
+        for (std::size_t i = 0; i < shape.m; ++i) {
+            for (std::size_t j = 0; j < shape.n; ++j) {
+                T sum = beta * c[i * shape.n + j];
+                for (std::size_t p = 0; p < shape.k; ++p) {
+                    T x = shape.transA ? a[p * shape.m + i] : a[i * shape.k + p];
+                    T y = shape.transB ? b[j * shape.k + p] : b[p * shape.n + j];
+                    sum += x * y;
+                }
+                result[i * shape.n + j] = sum;
+            }
+        }
+        return result;
+    }
+
+    template <typename T>
+    std::vector<T> Sequence(std::size_t size, int mod) {
+        std::vector<T> values(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            values[i] = static_cast<T>(static_cast<int>(i * 7 % mod) - mod / 2);
+        }
+        return values;
+    }
+
+    // Batch() 组互相独立的 1 x 1 x 1 乘法 c[batch] = 2 * 3，每组一个宏块；slowBatch 的宏块在其余宏块都开始执行
+    // （或超时）之前不会结束，并记录各宏块由哪个工作线程执行
+    struct SlowTileSource {
+        ThreadPool* pool;
+        std::vector<float>* c;
+        std::vector<std::size_t>* workers;
+        std::atomic<std::size_t>* started;
+        std::atomic<bool>* overlapped;
+        std::size_t slowBatch;
+
+        std::size_t Batch() const { return c->size(); }
+        std::size_t M() const { return 1; }
+        std::size_t N() const { return 1; }
+        std::size_t K() const { return 1; }
+        std::size_t Ldc() const { return 1; }
+        float* C(std::size_t batch) const { return c->data() + batch; }
+
+        void PackA(float* packed, std::size_t mr, std::size_t batch, std::size_t, std::size_t, std::size_t,
+                   std::size_t) const {
+            std::fill_n(packed, mr, 0.0f);
+            packed[0] = 2.0f;
+            (*workers)[batch] = pool->CurrentWorker();
+            started->fetch_add(1);
+            if (batch == slowBatch) {
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                while (started->load() < Batch() && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::yield();
+                }
+                *overlapped = started->load() == Batch();
+            }
+        }
+
+        void PackB(float* packed, std::size_t nr, std::size_t, std::size_t, std::size_t, std::size_t,
+                   std::size_t) const {
+            std::fill_n(packed, nr, 0.0f);
+            packed[0] = 3.0f;
+        }
+    };
+}
+
+SCENARIO("Test matmul matches naive result on every isa") {
+    auto isa = GENERATE(IsaVariant::SCALAR, IsaVariant::AVX2, IsaVariant::AVX512);
+    IsaGuard guard(isa);
+
+    // 小分块使边缘宏块、边缘子块与多个 kc 面板都被覆盖；整数值保证 float 结果精确
+    MatmulShape shape{37, 53, 71};
+    shape.transA = GENERATE(false, true);
+    shape.transB = GENERATE(false, true);
+    std::vector<float> a = Sequence<float>(shape.m * shape.k, 9);
+    std::vector<float> b = Sequence<float>(shape.k * shape.n, 5);
+    std::vector<float> c = Sequence<float>(shape.m * shape.n, 3);
+    std::vector<float> expected = NaiveMatmul(a, b, c, shape, 2.0f);
+
+    Matmul<float> matmul(MatmulBlocking{20, 16, 40});
+    matmul.Run(AddrOf(a), AddrOf(b), AddrOf(c), shape, 2.0f);
+    REQUIRE(c == expected);
+}
+
+SCENARIO("Test matmul on thread pool") {
+    ThreadPool pool(3);
+    MatmulShape shape{130, 200, 150};
+    std::vector<double> a = Sequence<double>(shape.m * shape.k, 11);
+    std::vector<double> b = Sequence<double>(shape.k * shape.n, 7);
+    std::vector<double> c(shape.m * shape.n, 1.0);
+    std::vector<double> expected = NaiveMatmul(a, b, c, shape, 0.0);
+
+    Matmul<double> matmul(MatmulBlocking{32, 64, 64});
+
+    GIVEN("static schedule") {
+        matmul.RunParallel(pool, 3, AddrOf(a), AddrOf(b), AddrOf(c), shape);
+        REQUIRE(c == expected);
+    }
+
+    GIVEN("stealing schedule") {
+        matmul.RunWithConfig(LaunchConfig{&pool, AUTO_BLOCK_DIM, LaunchSchedule::STEALING},
+                             AddrOf(a), AddrOf(b), AddrOf(c), shape);
+        REQUIRE(c == expected);
+    }
+
+    GIVEN("default blocking on float") {
+        std::vector<float> af(a.begin(), a.end()), bf(b.begin(), b.end()), cf(c.size());
+        Matmul<float>().RunParallel(pool, AUTO_BLOCK_DIM, AddrOf(af), AddrOf(bf), AddrOf(cf), shape);
+        for (std::size_t i = 0; i < cf.size(); ++i) {
+            REQUIRE(cf[i] == static_cast<float>(expected[i]));
+        }
+    }
+}
+
+SCENARIO("Test blocked gemm stealing lets idle workers take another block's macro-tiles") {
+    // 2 个 block 各持有 8 个连续的宏块；block 1 的第一个宏块（8）阻塞其所属线程，
+    // 它的其余宏块只能由做完 block 0 的空闲线程窃取
+    ThreadPool pool(2);
+    std::vector<float> c(16, 0.0f);
+    std::vector<std::size_t> workers(c.size(), pool.Size());
+    std::atomic<std::size_t> started{0};
+    std::atomic<bool> overlapped{false};
+    SlowTileSource source{&pool, &c, &workers, &started, &overlapped, 8};
+    BlockedGemm<float, SlowTileSource>::Run(LaunchConfig{&pool, 2, LaunchSchedule::STEALING}, MatmulBlocking(),
+                                            source, 0.0f, "SlowTileSource");
+
+    REQUIRE(overlapped);
+    REQUIRE(c == std::vector<float>(c.size(), 6.0f));
+    std::size_t stolen = 0;
+    for (std::size_t tile = 9; tile < c.size(); ++tile) {
+        stolen += workers[tile] != workers[8];
+    }
+    REQUIRE(stolen > 0);
+}
+
+SCENARIO("Test matmul resolves tuned launch configs and records simulator tiles") {
+    // 标量微内核为 4 x 8：mc = 96，tileSize = 12 向上取整为 16 列，130 x 200 的 C 共 2 x 13 个宏块
+    IsaGuard guard(IsaVariant::SCALAR);
+    ThreadPool pool(2);
+    Autotuner& tuner = Autotuner::Default();
+    tuner.Clear();
+    MatmulShape shape{130, 200, 150};
+    std::vector<float> a = Sequence<float>(shape.m * shape.k, 11);
+    std::vector<float> b = Sequence<float>(shape.k * shape.n, 7);
+    std::vector<float> c(shape.m * shape.n);
+    std::vector<float> expected = NaiveMatmul(a, b, c, shape, 0.0f);
+    tuner.Set(Matmul<float>::Signature(), Autotuner::CountBucket(shape.m * shape.n), TunedConfig{3, 12, 0.0});
+
+    Simulator::Clear();
+    Simulator::Enable();
+    Matmul<float>().RunParallel(pool, AUTO_BLOCK_DIM, AddrOf(a), AddrOf(b), AddrOf(c), shape);
+    Simulator::Enable(false);
+    tuner.Clear();
+
+    REQUIRE(c == expected);
+    auto records = Simulator::Records();
+    REQUIRE(records.size() == 1);
+    REQUIRE(records[0].count == shape.m * shape.n);
+    REQUIRE(records[0].blockDim == 3);
+    REQUIRE(records[0].tileSize == 96 * 16);
+    REQUIRE(records[0].estimate.cycles > 0.0);
+    Simulator::Clear();
+}
+
+SCENARIO("Test matmul degenerate shapes") {
+    std::vector<std::int32_t> a{1, 2, 3, 4, 5, 6};
+    std::vector<std::int32_t> b{1, 0, 0, 1, 1, 1};
+    std::vector<std::int32_t> c(4, 9);
+    Matmul<std::int32_t> matmul;
+
+    matmul.Run(AddrOf(a), AddrOf(b), AddrOf(c), MatmulShape{2, 2, 3});
+    REQUIRE(c == std::vector<std::int32_t>{4, 5, 10, 11});
+
+    // k 为 0 时只做 C = beta * C
+    matmul.Run(AddrOf(a), AddrOf(b), AddrOf(c), MatmulShape{2, 2, 0}, 2);
+    REQUIRE(c == std::vector<std::int32_t>{8, 10, 20, 22});
+
+    STATIC_REQUIRE(Matmul<float>::TYPE == KernelType::MATMUL);
+}
@@ -0,0 +1,205 @@
+#include "catch2/catch.hpp"
+#include "autotuner.h"
+#include "normalization.h"
+#include "simulator.h"
+#include "thread_pool.h"
+#include "unified_buffer.h"
+#include "vector_ops.h"
+#include "test_util.h"
+#include <cmath>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    // 先求整行 max / sum，再逐元素归一化的两遍参考实现
+    std::vector<double> NaiveSoftmax(const std::vector<double>& x, std::size_t rows, std::size_t cols) {
+        std::vector<double> y(x.size());
+        for (std::size_t r = 0; r < rows; ++r) {
+            const double* row = x.data() + r * cols;
+            double max = *std::max_element(row, row + cols);
+            double sum = 0.0;
+            for (std::size_t c = 0; c < cols; ++c) {
+                sum += std::exp(row[c] - max);
+            }
+            for (std::size_t c = 0; c < cols; ++c) {
+                y[r * cols + c] = std::exp(row[c] - max) / sum;
+            }
+        }
+        return y;
+    }
+
+    std::vector<double> NaiveLayerNorm(const std::vector<double>& x, const std::vector<double>& gamma,
+                                       const std::vector<double>& beta, std::size_t rows, std::size_t cols,
+                                       double epsilon) {
+        std::vector<double> y(x.size());
+        for (std::size_t r = 0; r < rows; ++r) {
+            const double* row = x.data() + r * cols;
+            double mean = 0.0;
+            for (std::size_t c = 0; c < cols; ++c) {
+                mean += row[c];
+            }
+            mean /= cols;
+            double var = 0.0;
+            for (std::size_t c = 0; c < cols; ++c) {
+                var += (row[c] - mean) * (row[c] - mean);
+            }
+            var /= cols;
+            for (std::size_t c = 0; c < cols; ++c) {
+                double g = gamma.empty() ? 1.0 : gamma[c];
+                double b = beta.empty() ? 0.0 : beta[c];
+                y[r * cols + c] = (row[c] - mean) / std::sqrt(var + epsilon) * g + b;
+            }
+        }
+        return y;
+    }
+
+    std::vector<double> Wave(std::size_t size, double scale, double bias) {
+        std::vector<double> values(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            values[i] = bias + scale * std::sin(0.37 * i) + 0.01 * (i % 13);
+        }
+        return values;
+    }
+
+    template <typename T, typename U>
+    std::vector<T> Cast(const std::vector<U>& values) {
+        return std::vector<T>(values.begin(), values.end());
+    }
+
+    template <typename T>
+    void RequireClose(const std::vector<T>& actual, const std::vector<double>& expected, double epsilon) {
+        REQUIRE(actual.size() == expected.size());
+        for (std::size_t i = 0; i < actual.size(); ++i) {
+            REQUIRE(static_cast<double>(actual[i]) == Approx(expected[i]).epsilon(epsilon).margin(epsilon));
+        }
+    }
+}
+
+SCENARIO("Test softmax matches two-pass reference on every isa") {
+    auto isa = GENERATE(IsaVariant::SCALAR, IsaVariant::AVX2, IsaVariant::AVX512);
+    IsaGuard guard(isa);
+
+    // tile 小于一行时 max 会在后续 tile 中变大，覆盖在线修正 sum 的分支
+    std::size_t rows = 5;
+    std::size_t cols = 203;
+    auto tileSize = GENERATE(std::size_t(0), std::size_t(16), std::size_t(50));
+    std::vector<double> reference = Wave(rows * cols, 4.0, 0.0);
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        reference[i] += 0.05 * (i % cols);
+    }
+    std::vector<float> x = Cast<float>(reference);
+    std::vector<float> y(x.size());
+
+    Softmax<float>().RunWithConfig(LaunchConfig{nullptr, 1, LaunchSchedule::STATIC, tileSize},
+                                   AddrOf(x), AddrOf(y), rows, cols);
+    RequireClose(y, NaiveSoftmax(reference, rows, cols), 1e-5);
+}
+
+SCENARIO("Test softmax does not overflow on large inputs") {
+    std::vector<double> reference = Wave(3 * 100, 50.0, 1000.0);
+    std::vector<double> y(reference.size());
+    Softmax<double>().RunWithConfig(LaunchConfig{nullptr, 1, LaunchSchedule::STATIC, 32},
+                                    AddrOf(reference), AddrOf(y), 3, 100);
+    RequireClose(y, NaiveSoftmax(reference, 3, 100), 1e-12);
+
+    double rowSum = 0.0;
+    for (std::size_t c = 0; c < 100; ++c) {
+        rowSum += y[c];
+    }
+    REQUIRE(rowSum == Approx(1.0));
+}
+
+SCENARIO("Test layernorm matches reference on every isa") {
+    auto isa = GENERATE(IsaVariant::SCALAR, IsaVariant::AVX2, IsaVariant::AVX512);
+    IsaGuard guard(isa);
+
+    std::size_t rows = 4;
+    std::size_t cols = 300;
+    auto tileSize = GENERATE(std::size_t(0), std::size_t(64), std::size_t(77));
+    auto affine = GENERATE(false, true);
+    // 均值远大于标准差，检验合并 tile 统计量时没有相消误差
+    std::vector<double> reference = Wave(rows * cols, 0.5, 1000.0);
+    std::vector<double> gamma = affine ? Wave(cols, 1.0, 1.5) : std::vector<double>();
+    std::vector<double> beta = affine ? Wave(cols, 0.3, -0.2) : std::vector<double>();
+    std::vector<float> x = Cast<float>(reference);
+    std::vector<float> gammaF = Cast<float>(gamma);
+    std::vector<float> betaF = Cast<float>(beta);
+    std::vector<float> y(x.size());
+
+    LayerNorm<float> layerNorm(1e-5f);
+    layerNorm.RunWithConfig(LaunchConfig{nullptr, 1, LaunchSchedule::STATIC, tileSize}, AddrOf(x),
+                            AddrOf(gammaF), AddrOf(betaF), AddrOf(y), rows, cols);
+    RequireClose(y, NaiveLayerNorm(Cast<double>(Cast<float>(reference)), gamma, beta, rows, cols, 1e-5), 2e-3);
+}
+
+SCENARIO("Test fused normalization reads each row twice") {
+    std::size_t rows = 6;
+    std::size_t cols = 1000;
+    std::vector<float> x = Cast<float>(Wave(rows * cols, 2.0, 0.0));
+    std::vector<float> y(x.size());
+    LaunchConfig config{nullptr, 1, LaunchSchedule::STATIC, 128};
+
+    UnifiedBuffer& ub = UnifiedBuffer::Current();
+    ub.ResetStats();
+    Softmax<float>().RunWithConfig(config, AddrOf(x), AddrOf(y), rows, cols);
+    REQUIRE(ub.CopyInBytes() == 2 * x.size() * sizeof(float));
+    REQUIRE(ub.CopyOutBytes() == y.size() * sizeof(float));
+
+    ub.ResetStats();
+    LayerNorm<float>().RunWithConfig(config, AddrOf(x), nullptr, nullptr, AddrOf(y), rows, cols);
+    REQUIRE(ub.CopyInBytes() == 2 * x.size() * sizeof(float));
+    REQUIRE(ub.CopyOutBytes() == y.size() * sizeof(float));
+
+    // UB 中只有 tile 大小的缓冲
+    REQUIRE(ub.Used() == 0);
+    REQUIRE(ub.Peak() < 4 * 128 * sizeof(float));
+}
+
+SCENARIO("Test fused normalization on thread pool") {
+    ThreadPool pool(3);
+    std::size_t rows = 37;
+    std::size_t cols = 129;
+    auto schedule = GENERATE(LaunchSchedule::STATIC, LaunchSchedule::STEALING);
+    LaunchConfig config{&pool, AUTO_BLOCK_DIM, schedule, 40};
+    std::vector<double> x = Wave(rows * cols, 3.0, 1.0);
+    std::vector<double> gamma = Wave(cols, 1.0, 1.0);
+    std::vector<double> beta = Wave(cols, 1.0, 0.0);
+    std::vector<double> y(x.size());
+
+    Softmax<double>().RunWithConfig(config, AddrOf(x), AddrOf(y), rows, cols);
+    RequireClose(y, NaiveSoftmax(x, rows, cols), 1e-12);
+
+    LayerNorm<double>(1e-6).RunWithConfig(config, AddrOf(x), AddrOf(gamma), AddrOf(beta), AddrOf(y), rows, cols);
+    RequireClose(y, NaiveLayerNorm(x, gamma, beta, rows, cols, 1e-6), 1e-9);
+}
+
+SCENARIO("Test row kernels resolve tuned launch configs") {
+    ThreadPool pool(2);
+    Autotuner& tuner = Autotuner::Default();
+    tuner.Clear();
+    std::size_t rows = 6;
+    std::size_t cols = 100;
+    std::vector<float> x = Cast<float>(Wave(rows * cols, 2.0, 0.5));
+    std::vector<float> y(x.size());
+    tuner.Set(Softmax<float>::Signature(), Autotuner::CountBucket(x.size()), TunedConfig{3, 32, 0.0});
+    tuner.Set(LayerNorm<float>::Signature(), Autotuner::CountBucket(x.size()), TunedConfig{5, 48, 0.0});
+
+    Simulator::Clear();
+    Simulator::Enable();
+    Softmax<float>().RunParallel(pool, AUTO_BLOCK_DIM, AddrOf(x), AddrOf(y), rows, cols);
+    RequireClose(y, NaiveSoftmax(Cast<double>(x), rows, cols), 1e-5);
+    LayerNorm<float>().RunParallel(pool, AUTO_BLOCK_DIM, AddrOf(x), nullptr, nullptr, AddrOf(y), rows, cols);
+    RequireClose(y, NaiveLayerNorm(Cast<double>(x), {}, {}, rows, cols, 1e-5), 1e-4);
+    Simulator::Enable(false);
+    tuner.Clear();
+
+    auto records = Simulator::Records();
+    REQUIRE(records.size() == 2);
+    REQUIRE(records[0].blockDim == 3);
+    REQUIRE(records[0].tileSize == 32);
+    REQUIRE(records[1].blockDim == 5);
+    REQUIRE(records[1].tileSize == 48);
+    Simulator::Clear();
+}
@@ -0,0 +1,69 @@
+#include "catch2/catch.hpp"
+#include "numa.h"
+#include "thread_pool.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    // 在临时目录下构造与 /sys/devices/system/node 相同结构的拓扑
+    std::string MakeFakeSysNode() {
+        char path[] = "/tmp/asl_numa_XXXXXX";
+        std::string root = mkdtemp(path);
+        const char* lists[] = { "0-1\n", "2-3\n", "\n" };
+        for (int node = 0; node < 3; ++node) {
+            std::string dir = root + "/node" + std::to_string(node);
+            mkdir(dir.c_str(), 0755);
+            std::ofstream(dir + "/cpulist") << lists[node];
+        }
+        std::ofstream(root + "/possible") << "0-2\n";
+        return root;
+    }
+}
+
+SCENARIO("Test parse cpu list") {
+    REQUIRE(ParseCpuList("0-3,8,10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+    REQUIRE(ParseCpuList("5") == std::vector<int>{5});
+    REQUIRE(ParseCpuList("").empty());
+}
+
+SCENARIO("Test numa topology from sys node directory") {
+    std::string root = MakeFakeSysNode();
+
+    NumaTopology topology = NumaTopology::Detect(root, false);
+    REQUIRE(topology.NodeCount() == 2);
+    REQUIRE(topology.Nodes()[0].cpus == std::vector<int>{0, 1});
+    REQUIRE(topology.Nodes()[1].id == 1);
+    REQUIRE(topology.CpuCount() == 4);
+    REQUIRE(topology.NodeOfCpu(3) == 1);
+    REQUIRE(topology.NodeOfCpu(9) == 2);
+
+    NumaTopology fallback = NumaTopology::Detect(root + "/missing");
+    REQUIRE(fallback.NodeCount() == 1);
+    REQUIRE(fallback.CpuCount() >= 1);
+
+    std::filesystem::remove_all(root);
+}
+
+SCENARIO("Test numa aware thread pool orders workers by node") {
+    std::string root = MakeFakeSysNode();
+    NumaTopology topology = NumaTopology::Detect(root, false);
+    std::filesystem::remove_all(root);
+
+    ThreadPool pool(topology, 2);
+    REQUIRE(pool.Size() == 4);
+    REQUIRE(pool.NodeCount() == 2);
+    REQUIRE(pool.NodeOfWorker(0) == 0);
+    REQUIRE(pool.NodeOfWorker(1) == 0);
+    REQUIRE(pool.NodeOfWorker(2) == 1);
+    REQUIRE(pool.NodeOfWorker(3) == 1);
+
+    std::vector<std::size_t> nodes(4);
+    pool.Dispatch(4, [&pool, &nodes](std::size_t i) { nodes[i] = pool.NodeOfWorker(pool.CurrentWorker()); });
+    REQUIRE(nodes == std::vector<std::size_t>{0, 0, 1, 1});
+}
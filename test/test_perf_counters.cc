@@ -0,0 +1,65 @@
+#include "catch2/catch.hpp"
+#include "kernel_ops.h"
+#include "perf_counters.h"
+#include "thread_pool.h"
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+SCENARIO("Test perf counters aggregate by kernel signature") {
+    PerfCounters::Reset();
+    PerfSample delta;
+    delta.values[0] = 1000;
+    delta.values[1] = 2500;
+    delta.valid[0] = delta.valid[1] = true;
+    PerfCounters::Accumulate(typeid(int).name(), 100, delta);
+    PerfCounters::Accumulate(typeid(int).name(), 300, delta);
+
+    auto snapshot = PerfCounters::Snapshot();
+    REQUIRE(snapshot.size() == 1);
+    const KernelCounters& counters = snapshot["int"];
+    REQUIRE(counters.samples == 2);
+    REQUIRE(counters.elements == 400);
+    REQUIRE(counters[PerfEvent::CYCLES] == 2000);
+    REQUIRE(counters.Ipc() == 2.5);
+    REQUIRE_FALSE(counters.valid[static_cast<std::size_t>(PerfEvent::DTLB_MISSES)]);
+    REQUIRE(PerfCounters::Dump().find("IPC") != std::string::npos);
+
+    PerfCounters::Reset();
+    REQUIRE(PerfCounters::Snapshot().empty());
+}
+
+SCENARIO("Test perf counters around kernel launches") {
+    PerfCounters::Reset();
+    std::size_t count = 4096;
+    std::vector<float> inputs(count * 2, 1.0f);
+    std::vector<float> output(count);
+    Addr in  = reinterpret_cast<Addr>(inputs.data());
+    Addr out = reinterpret_cast<Addr>(output.data());
+    BinaryElemWise<OpAdd, float> kernel;
+
+    kernel.Run(in, in, out, count);
+    REQUIRE(PerfCounters::Snapshot().empty());
+
+    PerfCounters::Enable();
+    kernel.Run(in, in, out, count);
+    ThreadPool pool(2);
+    kernel.RunParallel(pool, 2, in, in, out, count);
+    PerfCounters::Enable(false);
+
+    // 容器或虚拟机中通常没有 PMU，此时计数静默跳过
+    if (!PerfCounters::Available()) {
+        REQUIRE(PerfCounters::Snapshot().empty());
+        return;
+    }
+    auto snapshot = PerfCounters::Snapshot();
+    REQUIRE(snapshot.size() == 1);
+    const KernelCounters& counters = snapshot.begin()->second;
+    REQUIRE(snapshot.begin()->first.find("OpAdd") != std::string::npos);
+    REQUIRE(counters.elements == 2 * count);
+    if (counters.valid[static_cast<std::size_t>(PerfEvent::INSTRUCTIONS)]) {
+        REQUIRE(counters[PerfEvent::INSTRUCTIONS] > 0);
+    }
+    PerfCounters::Reset();
+}
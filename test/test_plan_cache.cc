@@ -0,0 +1,138 @@
+#include "catch2/catch.hpp"
+#include "autotuner.h"
+#include "kernel_ops.h"
+#include "plan_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    ExecutionPlan MakePlan(std::string_view signature, std::uint32_t bucket, IsaVariant isa, std::uint32_t blockDim) {
+        ExecutionPlan plan{};
+        plan.signatureHash = PlanSignatureHash(signature);
+        plan.countBucket = bucket;
+        plan.isa = isa;
+        plan.blockDim = blockDim;
+        plan.tileSize = blockDim * 1024;
+        return plan;
+    }
+}
+
+SCENARIO("Test plan cache isa and signature hash") {
+    std::string name = IsaName(DetectIsa());
+    REQUIRE((name == "scalar" || name == "avx2" || name == "avx512"));
+    REQUIRE(PlanSignatureHash("") == 14695981039346656037ull);
+    REQUIRE(PlanSignatureHash("a") == 0xaf63dc4c8601ec8cull);
+    REQUIRE(PlanSignatureHash("kernelA") != PlanSignatureHash("kernelB"));
+}
+
+SCENARIO("Test plan cache saves and maps plans") {
+    std::string path = "/tmp/asl_plan_cache_test.bin";
+    {
+        PlanCache cache;
+        cache.Insert(MakePlan("kernelB", 12, IsaVariant::AVX2, 2));
+        cache.Insert(MakePlan("kernelA", 10, IsaVariant::AVX2, 4));
+        cache.Insert(MakePlan("kernelA", 10, IsaVariant::SCALAR, 1));
+        cache.Insert(MakePlan("kernelA", 10, IsaVariant::AVX2, 8));
+        REQUIRE(cache.Size() == 3);
+        REQUIRE(cache.Save(path));
+    }
+
+    PlanCache cache;
+    REQUIRE(cache.Open(path));
+    REQUIRE(cache.Size() == 3);
+
+    ExecutionPlan plan;
+    REQUIRE(cache.Find("kernelA", 10, IsaVariant::AVX2, plan));
+    REQUIRE(plan.blockDim == 8);
+    REQUIRE(plan.tileSize == 8192);
+    REQUIRE(cache.Find("kernelA", 10, IsaVariant::SCALAR, plan));
+    REQUIRE(plan.blockDim == 1);
+    REQUIRE_FALSE(cache.Find("kernelA", 10, IsaVariant::AVX512, plan));
+    REQUIRE_FALSE(cache.Find("kernelB", 11, IsaVariant::AVX2, plan));
+
+    // 新插入的计划覆盖映射中的同键计划，保存后再映射仍然有序可查
+    cache.Insert(MakePlan("kernelB", 12, IsaVariant::AVX2, 16));
+    cache.Insert(MakePlan("kernelC", 3, IsaVariant::AVX2, 2));
+    REQUIRE(cache.Size() == 4);
+    REQUIRE(cache.Save(path));
+    REQUIRE(cache.Open(path));
+    REQUIRE(cache.Find("kernelB", 12, IsaVariant::AVX2, plan));
+    REQUIRE(plan.blockDim == 16);
+
+    cache.Clear();
+    REQUIRE(cache.Size() == 0);
+    std::remove(path.c_str());
+}
+
+SCENARIO("Test plan cache rejects invalid files") {
+    std::string path = "/tmp/asl_plan_cache_invalid.bin";
+    std::ofstream(path) << "not a plan cache file at all";
+    PlanCache cache;
+    REQUIRE_FALSE(cache.Open(path));
+    REQUIRE_FALSE(cache.Open("/tmp/asl_plan_cache_missing.bin"));
+    REQUIRE(cache.Size() == 0);
+    std::remove(path.c_str());
+}
+
+SCENARIO("Test plan cache rejects count that overflows file size") {
+    std::string path = "/tmp/asl_plan_cache_overflow.bin";
+    {
+        PlanCache cache;
+        cache.Insert(MakePlan("kernelA", 10, IsaVariant::AVX2, 4));
+        REQUIRE(cache.Save(path));
+    }
+    // 改写头部的 count：(count - 1) * sizeof(ExecutionPlan) 为 2^64 的倍数，
+    // 相乘回绕后恰好等于文件中一条计划的大小
+    std::uint64_t lowBit = sizeof(ExecutionPlan) & (~sizeof(ExecutionPlan) + 1);
+    std::uint64_t count = ~std::uint64_t(0) / lowBit + 2;
+    REQUIRE(count * sizeof(ExecutionPlan) == sizeof(ExecutionPlan));
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(16);
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+    PlanCache cache;
+    REQUIRE_FALSE(cache.Open(path));
+    REQUIRE(cache.Size() == 0);
+    std::remove(path.c_str());
+}
+
+SCENARIO("Test plan cache concurrent saves leave a valid file") {
+    std::string path = "/tmp/asl_plan_cache_concurrent.bin";
+    auto save = [&path](std::uint32_t blockDim) {
+        PlanCache cache;
+        cache.Insert(MakePlan("kernelA", 10, IsaVariant::AVX2, blockDim));
+        for (int i = 0; i < 20; ++i) {
+            cache.Save(path);
+        }
+    };
+    std::thread first(save, 2);
+    std::thread second(save, 4);
+    first.join();
+    second.join();
+
+    PlanCache cache;
+    REQUIRE(cache.Open(path));
+    ExecutionPlan plan;
+    REQUIRE(cache.Find("kernelA", 10, IsaVariant::AVX2, plan));
+    REQUIRE((plan.blockDim == 2 || plan.blockDim == 4));
+    std::remove(path.c_str());
+}
+
+SCENARIO("Test autotuner records layout in plan cache") {
+    using Kernel = ElemWise<OpAdd, Input<double, float>, Output<float>>;
+    Autotuner tuner;
+    tuner.Set(Kernel::Signature(), 8, TunedConfig{2, 0, 0.5}, Autotuner::LayoutOf<Kernel>());
+
+    ExecutionPlan plan;
+    REQUIRE(tuner.Cache().Find(Kernel::Signature(), 8, tuner.Isa(), plan));
+    REQUIRE(plan.layout.inputCount == 2);
+    REQUIRE(plan.layout.outputCount == 1);
+    REQUIRE(plan.layout.offsets[1] == sizeof(double));
+    REQUIRE(plan.layout.offsets[2] == 0);
+}
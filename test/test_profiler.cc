@@ -0,0 +1,75 @@
+#include "catch2/catch.hpp"
+#include "kernel_ops.h"
+#include "profiler.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    std::size_t CountKind(const std::vector<LaunchRecord>& records, RecordKind kind) {
+        return std::count_if(records.begin(), records.end(), [kind](const LaunchRecord& r) { return r.kind == kind; });
+    }
+}
+
+SCENARIO("Test profiler is off by default") {
+    // 环境变量 ASL_PROFILE 可能已开启 Profiler，这里显式关闭
+    Profiler::Enable(false);
+    Profiler::Clear();
+    std::vector<float> data(30, 1.0f);
+    Addr addr = reinterpret_cast<Addr>(data.data());
+    BinaryElemWise<OpAdd, float> kernel;
+    kernel.Run(addr, addr, addr + 20 * sizeof(float), 10);
+    REQUIRE(Profiler::Collect().empty());
+}
+
+SCENARIO("Test profiler records launches and blocks") {
+    Profiler::Clear();
+    Profiler::Enable();
+
+    std::size_t count = 1000;
+    std::vector<double> inputs(count * 2, 1.0);
+    std::vector<double> output(count);
+    Addr in  = reinterpret_cast<Addr>(inputs.data());
+    Addr out = reinterpret_cast<Addr>(output.data());
+
+    BinaryElemWise<OpAdd, double> kernel;
+    kernel.Run(in, in, out, count);
+
+    ThreadPool pool(2);
+    kernel.RunParallel(pool, 4, in, in, out, count);
+    Profiler::Enable(false);
+
+    auto records = Profiler::Collect();
+    REQUIRE(CountKind(records, RecordKind::LAUNCH) == 2);
+    REQUIRE(CountKind(records, RecordKind::BLOCK) == 4);
+
+    const LaunchRecord& first = records.front();
+    REQUIRE(first.kind == RecordKind::LAUNCH);
+    REQUIRE(first.count == count);
+    REQUIRE(first.bytesRead == 2 * sizeof(double) * count);
+    REQUIRE(first.bytesWritten == sizeof(double) * count);
+    REQUIRE(first.endNs >= first.startNs);
+    REQUIRE(first.GBps() >= 0.0);
+    REQUIRE(DemangleName(first.name).find("OpAdd") != std::string::npos);
+
+    std::size_t blockElems = 0;
+    for (auto& record : records) {
+        if (record.kind == RecordKind::BLOCK) {
+            blockElems += record.count;
+            REQUIRE(record.threadId != first.threadId);
+        }
+    }
+    REQUIRE(blockElems == count);
+
+    std::string trace = Profiler::ChromeTrace();
+    REQUIRE(trace.find("\"traceEvents\":[{") != std::string::npos);
+    REQUIRE(trace.find("\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(trace.find("\"cat\":\"block\"") != std::string::npos);
+    REQUIRE(trace.find("\"bytesWritten\":8000") != std::string::npos);
+
+    Profiler::Clear();
+    REQUIRE(Profiler::Collect().empty());
+}
@@ -0,0 +1,250 @@
+#include "catch2/catch.hpp"
+#include "autotuner.h"
+#include "reduce.h"
+#include "simulator.h"
+#include "thread_pool.h"
+#include "vector_ops.h"
+#include "test_util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    // 逐元素计算输出下标的参考实现
+    template <typename T>
+    std::vector<T> NaiveReduce(const std::vector<T>& x, const std::vector<std::size_t>& dims,
+                               const std::vector<std::size_t>& axes, ReduceOp op) {
+        std::vector<bool> reduced(dims.size(), false);
+        for (std::size_t axis : axes) {
+            reduced[axis] = true;
+        }
+        std::size_t outCount = 1;
+        std::size_t reducedCount = 1;
+        for (std::size_t i = 0; i < dims.size(); ++i) {
+            (reduced[i] ? reducedCount : outCount) *= dims[i];
+        }
+        std::vector<T> y(outCount, op == ReduceOp::MAX ? -1e30f : op == ReduceOp::MIN ? 1e30f : 0);
+        for (std::size_t index = 0; index < x.size(); ++index) {
+            std::size_t rest = index;
+            std::size_t out = 0;
+            std::size_t stride = 1;
+            for (std::size_t i = dims.size(); i-- > 0;) {
+                std::size_t coord = rest % dims[i];
+                rest /= dims[i];
+                if (!reduced[i]) {
+                    out += coord * stride;
+                    stride *= dims[i];
+                }
+            }
+            switch (op) {
+            case ReduceOp::SUM:
+            case ReduceOp::MEAN: y[out] += x[index]; break;
+            case ReduceOp::MAX:  y[out] = std::max(y[out], x[index]); break;
+            case ReduceOp::MIN:  y[out] = std::min(y[out], x[index]); break;
+            }
+        }
+        if (op == ReduceOp::MEAN) {
+            for (auto& value : y) {
+                value /= reducedCount;
+            }
+        }
+        return y;
+    }
+
+    std::vector<float> Sequence(std::size_t size) {
+        std::vector<float> values(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            values[i] = static_cast<float>(static_cast<int>(i * 37 % 101) - 50);
+        }
+        return values;
+    }
+
+    std::size_t Product(const std::vector<std::size_t>& dims) {
+        std::size_t count = 1;
+        for (std::size_t dim : dims) {
+            count *= dim;
+        }
+        return count;
+    }
+}
+
+SCENARIO("Test reduce axes collapse") {
+    auto segments = CollapseReduceAxes({2, 3, 1, 4, 5, 6}, {1, 2, 3});
+    REQUIRE(segments.size() == 3);
+    REQUIRE(segments[0].size == 2);
+    REQUIRE_FALSE(segments[0].reduced);
+    REQUIRE(segments[1].size == 12);
+    REQUIRE(segments[1].reduced);
+    REQUIRE(segments[2].size == 30);
+    REQUIRE_FALSE(segments[2].reduced);
+
+    REQUIRE(ReduceOutputDims({2, 3, 4}, {1}) == std::vector<std::size_t>{2, 4});
+    REQUIRE(ReduceOutputDims({2, 3, 4}, {0, 2}, true) == std::vector<std::size_t>{1, 3, 1});
+
+    REQUIRE_THROWS_AS(CollapseReduceAxes({2, 3}, {2}), std::invalid_argument);
+    REQUIRE_THROWS_AS(CollapseReduceAxes({2, 3}, {1, 1}), std::invalid_argument);
+}
+
+SCENARIO("Test reduce over inner, outer and middle axes on every isa") {
+    auto isa = GENERATE(IsaVariant::SCALAR, IsaVariant::AVX2, IsaVariant::AVX512);
+    IsaGuard guard(isa);
+
+    auto op = GENERATE(ReduceOp::SUM, ReduceOp::MEAN, ReduceOp::MAX, ReduceOp::MIN);
+    // tile 为 16 个元素：inner 为 3（窄列，多行合并）、40（宽列，切列块）以及沿最内维的多个 tile
+    std::vector<std::size_t> dims{5, 7, 9, 40};
+    auto axes = GENERATE(std::vector<std::size_t>{3},           // inner
+                         std::vector<std::size_t>{0},           // outer
+                         std::vector<std::size_t>{1},           // middle
+                         std::vector<std::size_t>{1, 2},        // 合并为一段的 middle
+                         std::vector<std::size_t>{0, 2},        // 不连续，两段
+                         std::vector<std::size_t>{0, 1, 2, 3},  // 全部
+                         std::vector<std::size_t>{});
+    auto tileSize = GENERATE(std::size_t(0), std::size_t(16));
+
+    std::vector<float> x = Sequence(Product(dims));
+    std::vector<float> y(Product(ReduceOutputDims(dims, axes)), 1234.0f);
+    Reduce<float>(op).RunWithConfig(LaunchConfig{nullptr, 1, LaunchSchedule::STATIC, tileSize},
+                                    AddrOf(x), AddrOf(y), dims, axes);
+
+    // 整数值的和在 float 中精确；MEAN 只有最后一次缩放的舍入
+    std::vector<float> expected = NaiveReduce(x, dims, axes, op);
+    for (std::size_t i = 0; i < y.size(); ++i) {
+        REQUIRE(y[i] == Approx(expected[i]).epsilon(1e-6));
+    }
+}
+
+SCENARIO("Test reduce with narrow inner axis") {
+    std::vector<std::size_t> dims{1000, 3};
+    std::vector<float> x = Sequence(Product(dims));
+    std::vector<float> y(3);
+    auto tileSize = GENERATE(std::size_t(0), std::size_t(16), std::size_t(2));
+    Reduce<float>().RunWithConfig(LaunchConfig{nullptr, 1, LaunchSchedule::STATIC, tileSize},
+                                  AddrOf(x), AddrOf(y), dims, {0});
+    REQUIRE(y == NaiveReduce(x, dims, {0}, ReduceOp::SUM));
+}
+
+SCENARIO("Test reduce over empty axis gives identity") {
+    std::vector<float> x;
+    std::vector<float> y(4, 1.0f);
+    Reduce<float>(ReduceOp::SUM).Run(AddrOf(x), AddrOf(y), {4, 0}, {1});
+    REQUIRE(y == std::vector<float>(4, 0.0f));
+    Reduce<float>(ReduceOp::MAX).Run(AddrOf(x), AddrOf(y), {4, 0}, {1});
+    REQUIRE(y[0] == -std::numeric_limits<float>::infinity());
+}
+
+SCENARIO("Test reduce rejects mean on integer types") {
+    REQUIRE_THROWS_AS(Reduce<int>(ReduceOp::MEAN), std::invalid_argument);
+    REQUIRE_THROWS_AS(Reduce<std::int64_t>(ReduceOp::MEAN, ReduceMode::DETERMINISTIC), std::invalid_argument);
+
+    std::vector<int> x{1, 2, 3, 4, 5, 6};
+    std::vector<int> y(2);
+    Reduce<int>(ReduceOp::SUM).Run(AddrOf(x), AddrOf(y), {2, 3}, {1});
+    REQUIRE(y == std::vector<int>{6, 15});
+}
+
+SCENARIO("Test reduce on thread pool") {
+    ThreadPool pool(3);
+    auto schedule = GENERATE(LaunchSchedule::STATIC, LaunchSchedule::STEALING);
+    LaunchConfig config{&pool, AUTO_BLOCK_DIM, schedule, 64};
+    std::vector<std::size_t> dims{6, 50, 70};
+    auto axes = GENERATE(std::vector<std::size_t>{2}, std::vector<std::size_t>{0}, std::vector<std::size_t>{1});
+
+    std::vector<double> x(Product(dims));
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<double>(i % 17) - 8.0;
+    }
+    std::vector<double> y(Product(ReduceOutputDims(dims, axes)));
+    Reduce<double>().RunWithConfig(config, AddrOf(x), AddrOf(y), dims, axes);
+    REQUIRE(y == NaiveReduce(x, dims, axes, ReduceOp::SUM));
+}
+
+SCENARIO("Test reduce resolves tuned launch configs and records simulator tiles") {
+    ThreadPool pool(2);
+    Autotuner& tuner = Autotuner::Default();
+    tuner.Clear();
+    std::vector<std::size_t> dims{8, 300};
+    std::vector<float> x = Sequence(Product(dims));
+    std::vector<float> y(8);
+    tuner.Set(Reduce<float>::Signature(), Autotuner::CountBucket(x.size()), TunedConfig{3, 64, 0.0});
+
+    Simulator::Clear();
+    Simulator::Enable();
+    Reduce<float>().RunParallel(pool, AUTO_BLOCK_DIM, AddrOf(x), AddrOf(y), dims, {1});
+    Simulator::Enable(false);
+    tuner.Clear();
+
+    REQUIRE(y == NaiveReduce(x, dims, {1}, ReduceOp::SUM));
+    auto records = Simulator::Records();
+    REQUIRE(records.size() == 1);
+    REQUIRE(records[0].count == x.size());
+    REQUIRE(records[0].blockDim == 3);
+    REQUIRE(records[0].tileSize == 64);
+    REQUIRE(records[0].estimate.cycles > 0.0);
+    Simulator::Clear();
+}
+
+SCENARIO("Test deterministic reduce is bitwise identical across launch configs") {
+    // 非整数值使不同的合并顺序产生不同的舍入
+    std::vector<std::size_t> dims{3, 1000, 7};
+    std::vector<float> x(Product(dims));
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = std::sin(0.7f * i) * 1000.0f + 1e-3f * (i % 11);
+    }
+    auto axes = GENERATE(std::vector<std::size_t>{1}, std::vector<std::size_t>{0, 1},
+                         std::vector<std::size_t>{2}, std::vector<std::size_t>{0, 1, 2});
+    auto op = GENERATE(ReduceOp::SUM, ReduceOp::MEAN);
+    Reduce<float> reduce(op, ReduceMode::DETERMINISTIC);
+    std::size_t outCount = Product(ReduceOutputDims(dims, axes));
+
+    std::vector<float> reference(outCount);
+    reduce.Run(AddrOf(x), AddrOf(reference), dims, axes);
+    std::vector<float> expected = NaiveReduce(x, dims, axes, op);
+    for (std::size_t i = 0; i < outCount; ++i) {
+        REQUIRE(reference[i] == Approx(expected[i]).epsilon(1e-4).margin(1e-2));
+    }
+
+    auto isa = GENERATE(IsaVariant::SCALAR, IsaVariant::AVX2, IsaVariant::AVX512);
+    IsaGuard guard(isa);
+    auto tileSize = GENERATE(std::size_t(0), std::size_t(1), std::size_t(300));
+    for (std::size_t threads = 1; threads <= 4; ++threads) {
+        ThreadPool pool(threads);
+        for (auto schedule : {LaunchSchedule::STATIC, LaunchSchedule::STEALING}) {
+            std::vector<float> y(outCount);
+            reduce.RunWithConfig(LaunchConfig{&pool, 2 * threads + 1, schedule, tileSize}, AddrOf(x), AddrOf(y),
+                                 dims, axes);
+            REQUIRE(std::memcmp(y.data(), reference.data(), outCount * sizeof(float)) == 0);
+        }
+    }
+}
+
+SCENARIO("Test deterministic reduce of a single long row runs on every block") {
+    ThreadPool pool(4);
+    std::vector<double> x(100000);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = 1.0 / (1.0 + i);
+    }
+    std::vector<double> y(1);
+    std::vector<double> reference(1);
+    Reduce<double> reduce(ReduceOp::SUM, ReduceMode::DETERMINISTIC);
+    Simulator::Clear();
+    Simulator::Enable();
+    reduce.Run(AddrOf(x), AddrOf(reference), {x.size()}, {0});
+    reduce.RunParallel(pool, AUTO_BLOCK_DIM, AddrOf(x), AddrOf(y), {x.size()}, {0});
+    Simulator::Enable(false);
+    REQUIRE(y[0] == reference[0]);
+    REQUIRE(y[0] == Approx(12.090146129863428));
+
+    // 模拟器按 block 记录每个叶子任务：单个输出的叶子分到 4 个 block 上，最慢的核只承担约四分之一的周期
+    auto records = Simulator::Records();
+    REQUIRE(records.size() == 2);
+    REQUIRE(records[0].blockDim == 1);
+    REQUIRE(records[1].blockDim == 4);
+    REQUIRE(records[1].estimate.cycles < records[0].estimate.cycles / 2);
+    Simulator::Clear();
+}
@@ -0,0 +1,85 @@
+#include "catch2/catch.hpp"
+#include "kernel_ops.h"
+#include "roofline.h"
+#include "thread_pool.h"
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    struct OpCopy {
+        template <typename T>
+        void operator()(Tensor<T> x, Tensor<T> y, std::size_t cnt) const {
+            for (std::size_t i = 0; i < cnt; ++i) {
+                y.data[i] = x.data[i];
+            }
+        }
+    };
+
+    struct OpPolynomial {
+        static constexpr double FLOPS_PER_ELEM = 16.0;
+
+        void operator()(Tensor<float> x, Tensor<float> y, std::size_t cnt) const {
+            for (std::size_t i = 0; i < cnt; ++i) {
+                float v = x.data[i];
+                float r = 0.0f;
+                for (int k = 0; k < 8; ++k) {
+                    r = r * v + 1.0f;
+                }
+                y.data[i] = r;
+            }
+        }
+    };
+}
+
+SCENARIO("Test kernels declare flops per element") {
+    STATIC_REQUIRE(KernelFlops<OpCopy>::value == 0.0);
+    STATIC_REQUIRE(BinaryElemWise<OpAdd, double>::FLOPS_PER_ELEM == 1.0);
+    STATIC_REQUIRE(BinaryElemWise<OpAdd, std::int32_t>::FLOPS_PER_ELEM == 0.0);
+    STATIC_REQUIRE(BinaryElemWise<OpAdd, std::int32_t>::OPS_PER_ELEM == 1.0);
+    STATIC_REQUIRE(BinaryElemWise<OpAdd, double>::IN_BYTES == 16);
+    STATIC_REQUIRE(BinaryElemWise<OpAdd, double>::OUT_BYTES == 8);
+    STATIC_REQUIRE(ElemWise<OpPolynomial, Input<float>, Output<float>>::FLOPS_PER_ELEM == 16.0);
+}
+
+SCENARIO("Test roofline report classifies kernels") {
+    MachinePeak peak{10.0, 40.0};
+    REQUIRE(peak.RidgeIntensity() == 4.0);
+
+    RooflineReport report(peak);
+    RooflinePoint add{"add", 1.0, 12.0, 1000000, 0.0024};
+    RooflinePoint poly{"poly", 64.0, 8.0, 1000000, 0.004};
+    report.Add(add);
+    report.Add(poly);
+
+    REQUIRE(report.MemoryBound(add));
+    REQUIRE_FALSE(report.MemoryBound(poly));
+    REQUIRE(report.AttainableGflops(add) == Approx(10.0 / 12.0));
+    REQUIRE(report.AttainableGflops(poly) == 40.0);
+    REQUIRE(report.Efficiency(add) == Approx(0.5));
+    REQUIRE(report.Efficiency(poly) == Approx(0.4));
+
+    std::string text = report.Format();
+    REQUIRE(text.find("ridge 4.000") != std::string::npos);
+    REQUIRE(text.find("memory") != std::string::npos);
+    REQUIRE(text.find("compute") != std::string::npos);
+}
+
+SCENARIO("Test roofline measures machine and kernels") {
+    ThreadPool pool(2);
+    MachinePeak peak = MeasureMachinePeak(pool, 1 << 20, 1);
+    REQUIRE(peak.bandwidthGBps > 0.0);
+    REQUIRE(peak.gflops > 0.0);
+
+    RooflineReport report(peak);
+    report.Measure<ElemWise<OpPolynomial, Input<float>, Output<float>>>(pool, "poly", 4096, 2);
+    report.Measure<ElemWise<OpCopy, Input<int>, Output<int>>>(pool, "copy", 4096, 2);
+    REQUIRE(report.Points().size() == 2);
+    REQUIRE(report.Points()[0].Intensity() == 2.0);
+    REQUIRE(report.Points()[1].Gflops() == 0.0);
+    REQUIRE(report.Points()[1].GBps() > 0.0);
+
+    MeasurePrebuiltKernels(report, pool, 1024);
+    REQUIRE(report.Points().size() == 2 + 24);
+    REQUIRE(report.Points().back().name == "OpMin<int64_t>");
+}
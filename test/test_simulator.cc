@@ -0,0 +1,120 @@
+#include "catch2/catch.hpp"
+#include "elem_wise.h"
+#include "simulator.h"
+#include "thread_pool.h"
+#include "unified_buffer.h"
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    MachineModel SimpleModel() {
+        MachineModel model;
+        model.coreNum = 2;
+        model.clockGHz = 1.0;
+        model.gmBandwidthGBps = 1000.0;
+        model.mteBytesPerCycle = 10.0;
+        model.vectorOpsPerCycle = 10.0;
+        model.copyLatencyCycles = 0.0;
+        model.launchOverheadUs = 0.0;
+        return model;
+    }
+
+    // 搬入 x 计算 2 倍后搬出，同时上报向量运算数
+    struct OpStagedDouble {
+        void operator()(Tensor<float> x, Tensor<float> y, std::size_t cnt) const {
+            LocalTensor<float> local = AllocLocal<float>(cnt);
+            DataCopy(local, x, cnt);
+            for (std::size_t i = 0; i < cnt; ++i) {
+                local[i] *= 2.0f;
+            }
+            UnifiedBuffer::Current().RecordVectorOps(cnt);
+            DataCopy(y, local, cnt);
+        }
+    };
+}
+
+SCENARIO("Test simulator pipeline estimate") {
+    MachineModel model = SimpleModel();
+
+    GIVEN("one tile per block") {
+        SimEstimate estimate = Simulator::Estimate(model, SimWorkload{{TileCost{100, 50, 200}}});
+        REQUIRE(estimate.cycles == Approx(10.0 + 20.0 + 5.0));
+        REQUIRE(estimate.seconds == Approx(35e-9));
+        REQUIRE(estimate.waves == 1);
+        REQUIRE(estimate.bound == SimBound::VECTOR);
+    }
+
+    GIVEN("many tiles with double buffering") {
+        SimWorkload workload{std::vector<TileCost>(8, TileCost{100, 100, 100})};
+        SimEstimate overlapped = Simulator::Estimate(model, workload);
+        model.doubleBuffer = false;
+        SimEstimate serial = Simulator::Estimate(model, workload);
+
+        REQUIRE(overlapped.cycles == Approx(8 * 10.0 + 20.0));
+        REQUIRE(serial.cycles > overlapped.cycles);
+        REQUIRE(serial.cycles <= Approx(8 * 30.0));
+    }
+
+    GIVEN("more blocks than cores") {
+        SimWorkload workload(5, std::vector<TileCost>{TileCost{100, 0, 0}});
+        SimEstimate estimate = Simulator::Estimate(model, workload);
+        REQUIRE(estimate.waves == 3);
+        REQUIRE(estimate.cycles == Approx(30.0));
+        REQUIRE(estimate.bound == SimBound::MTE_IN);
+    }
+
+    GIVEN("shared gm bandwidth") {
+        model.gmBandwidthGBps = 10.0;
+        SimEstimate estimate = Simulator::Estimate(model, SimWorkload(2, std::vector<TileCost>{TileCost{100, 0, 0}}));
+        REQUIRE(estimate.cycles == Approx(20.0));
+        REQUIRE(estimate.seconds == Approx(20e-9));
+    }
+}
+
+SCENARIO("Test simulator ranks tiling candidates") {
+    MachineModel model;
+    std::size_t count = std::size_t(1) << 20;
+    SimEstimate tiny = Simulator::EstimateElemWise(model, count, model.coreNum, 64, 8, 4, 1.0);
+    SimEstimate tiled = Simulator::EstimateElemWise(model, count, model.coreNum, 4096, 8, 4, 1.0);
+    SimEstimate oneCore = Simulator::EstimateElemWise(model, count, 1, 4096, 8, 4, 1.0);
+
+    REQUIRE(tiled.seconds < tiny.seconds);
+    REQUIRE(tiled.seconds < oneCore.seconds);
+}
+
+SCENARIO("Test simulator records kernel launches") {
+    Simulator::Clear();
+    Simulator::SetModel(SimpleModel());
+    Simulator::Enable();
+
+    std::size_t count = 1024;
+    std::vector<float> inputs(count, 1.0f);
+    std::vector<float> outputs(count, 0.0f);
+    ElemWise<OpStagedDouble, Input<float>, Output<float>> kernel;
+    ThreadPool pool(2);
+    kernel.RunWithConfig(LaunchConfig{&pool, 2, LaunchSchedule::STATIC, 256},
+                         reinterpret_cast<Addr>(inputs.data()), reinterpret_cast<Addr>(outputs.data()), count);
+
+    Simulator::Enable(false);
+    Simulator::SetModel(MachineModel());
+
+    REQUIRE(outputs[count - 1] == 2.0f);
+    auto records = Simulator::Records();
+    REQUIRE(records.size() == 1);
+    REQUIRE(records[0].count == count);
+    REQUIRE(records[0].blockDim == 2);
+    REQUIRE(records[0].tileSize == 256);
+    REQUIRE(records[0].hostSeconds > 0.0);
+
+    // 每个核两个 tile，每个 tile 搬入、搬出各 1024 字节，计算 256 个元素：102.4 + 25.6 + 102.4 周期的流水
+    SimEstimate expected = Simulator::Estimate(SimpleModel(), SimWorkload(2, std::vector<TileCost>(2, TileCost{1024, 1024, 256})));
+    REQUIRE(records[0].estimate.cycles == Approx(expected.cycles));
+    REQUIRE(records[0].estimate.bound == SimBound::MTE_IN);
+
+    std::string report = Simulator::Report();
+    REQUIRE(report.find("sim(us)") != std::string::npos);
+    REQUIRE(report.find("OpStagedDouble") != std::string::npos);
+    Simulator::Clear();
+}
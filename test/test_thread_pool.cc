@@ -0,0 +1,98 @@
+#include "catch2/catch.hpp"
+#include "thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+SCENARIO("Test thread pool submit") {
+    ThreadPool pool(2);
+    auto future = pool.Submit([]() { return 40 + 2; });
+    REQUIRE(future.get() == 42);
+}
+
+SCENARIO("Test thread pool parallel for") {
+    ThreadPool pool(4);
+    std::vector<int> values(1000, 0);
+    pool.ParallelFor(values.size(), [&values](std::size_t i) { values[i] = static_cast<int>(i) * 2; });
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        REQUIRE(values[i] == static_cast<int>(i) * 2);
+    }
+}
+
+SCENARIO("Test thread pool nested parallel for") {
+    ThreadPool pool(2);
+    std::atomic<int> sum{0};
+    pool.ParallelFor(8, [&pool, &sum](std::size_t) {
+        pool.ParallelFor(8, [&sum](std::size_t j) { sum += static_cast<int>(j); });
+    });
+    REQUIRE(sum.load() == 8 * 28);
+}
+
+SCENARIO("Test thread pool parallel for rethrows exception") {
+    ThreadPool pool(2);
+    REQUIRE_THROWS_AS(pool.ParallelFor(16, [](std::size_t i) {
+        if (i == 7) {
+            throw std::runtime_error("failed");
+        }
+    }), std::runtime_error);
+}
+
+SCENARIO("Test thread pool dispatch pins tasks to workers") {
+    ThreadPool pool(3);
+    REQUIRE(pool.CurrentWorker() == pool.Size());
+
+    for (int round = 0; round < 3; ++round) {
+        std::vector<std::size_t> workers(7, pool.Size());
+        pool.Dispatch(workers.size(), [&pool, &workers](std::size_t i) { workers[i] = pool.CurrentWorker(); });
+        for (std::size_t i = 0; i < workers.size(); ++i) {
+            REQUIRE(workers[i] == i % 3);
+        }
+    }
+}
+
+SCENARIO("Test thread pool dispatch stealing runs every chunk once") {
+    ThreadPool pool(3);
+    std::vector<std::atomic<int>> runs(5 * 16);
+    pool.DispatchStealing(5, 16, [&runs](std::size_t i) { runs[i].fetch_add(1); });
+    for (auto& run : runs) {
+        REQUIRE(run.load() == 1);
+    }
+
+    REQUIRE_THROWS_AS(pool.DispatchStealing(2, 4, [](std::size_t i) {
+        if (i == 5) {
+            throw std::runtime_error("failed");
+        }
+    }), std::runtime_error);
+}
+
+SCENARIO("Test thread pool dispatch stealing rebalances slow task") {
+    ThreadPool pool(2);
+    constexpr std::size_t CHUNKS = 8;
+    std::vector<std::size_t> workers(2 * CHUNKS, pool.Size());
+    pool.DispatchStealing(2, CHUNKS, [&pool, &workers](std::size_t i) {
+        workers[i] = pool.CurrentWorker();
+        if (i < CHUNKS) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    // 任务 1 的 chunk 很快完成，其线程随后窃取任务 0 剩余的 chunk
+    REQUIRE(workers[0] == 0);
+    std::set<std::size_t> slowTaskWorkers(workers.begin(), workers.begin() + CHUNKS);
+    REQUIRE(slowTaskWorkers.size() == 2);
+}
+
+SCENARIO("Test thread pool nested parallel for inside dispatch stealing") {
+    ThreadPool pool(2);
+    std::atomic<int> sum{0};
+    pool.DispatchStealing(2, 2, [&pool, &sum](std::size_t) {
+        pool.ParallelFor(10, [&sum](std::size_t j) { sum += static_cast<int>(j); });
+    });
+    REQUIRE(sum.load() == 4 * 45);
+}
@@ -0,0 +1,161 @@
+#include "catch2/catch.hpp"
+#include "elem_wise.h"
+#include "thread_pool.h"
+#include "tiling.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    // 仿照 AscendC 的写法：tiling 在 host 侧算好每个 block 的长度与 tile 数，kernel 只读取 TilingData
+    struct OpScale {
+        struct TilingData {
+            std::uint32_t blockLength;
+            std::uint32_t tileNum;
+            std::uint32_t tileLength;
+            float scale;
+        };
+
+        static std::atomic<int>& TilingCalls() {
+            static std::atomic<int> calls{0};
+            return calls;
+        }
+
+        // 各 block 在工作线程上观察到的 cnt、tiling.blockLength 与 GetBlockNum()，launch 结束后在测试线程上检查
+        // （Catch 的断言不是线程安全的，不能在 OP 内直接 REQUIRE）
+        struct Observed {
+            std::atomic<std::size_t> cnt{0};
+            std::atomic<std::size_t> blockLength{0};
+            std::atomic<std::size_t> blockNum{0};
+        };
+
+        static std::array<Observed, 4>& Observations() {
+            static std::array<Observed, 4> observations;
+            return observations;
+        }
+
+        static void Tiling(TilingContext& context, TilingData& tiling) {
+            TilingCalls()++;
+            context.blockDim = 4;
+            tiling.blockLength = static_cast<std::uint32_t>(context.count / context.blockDim);
+            tiling.tileNum = 2;
+            tiling.tileLength = tiling.blockLength / tiling.tileNum;
+            tiling.scale = 3.0f;
+        }
+
+        void operator()(Tensor<float> x, Tensor<float> y, std::size_t cnt, const TilingData& tiling) const {
+            for (std::uint32_t t = 0; t < tiling.tileNum; ++t) {
+                for (std::uint32_t i = 0; i < tiling.tileLength; ++i) {
+                    std::size_t index = t * tiling.tileLength + i;
+                    y.data[index] = x.data[index] * tiling.scale + static_cast<float>(GetBlockIdx());
+                }
+            }
+            std::size_t blockIdx = GetBlockIdx();
+            if (blockIdx < Observations().size()) {
+                Observations()[blockIdx].cnt = cnt;
+                Observations()[blockIdx].blockLength = tiling.blockLength;
+                Observations()[blockIdx].blockNum = GetBlockNum();
+            }
+        }
+    };
+
+    void ResetObservations() {
+        for (auto& observed : OpScale::Observations()) {
+            observed.cnt = 0;
+            observed.blockLength = 0;
+            observed.blockNum = 0;
+        }
+    }
+
+    void RequireObservations(std::size_t blockLength) {
+        for (auto& observed : OpScale::Observations()) {
+            REQUIRE(observed.cnt == blockLength);
+            REQUIRE(observed.blockLength == blockLength);
+            REQUIRE(observed.blockNum == 4);
+        }
+    }
+
+    using ScaleKernel = ElemWise<OpScale, Input<float>, Output<float>>;
+
+    // 已有的 tiling 函数通过宏注册给不带 TilingData 声明的 OP
+    struct OffsetTiling {
+        std::int32_t offset;
+    };
+
+    void ComputeOffsetTiling(TilingContext& context, OffsetTiling& tiling) {
+        tiling.offset = static_cast<std::int32_t>(context.count);
+    }
+
+    struct OpOffset {
+        void operator()(Tensor<int> x, Tensor<int> y, std::size_t cnt, const OffsetTiling& tiling, int extra) const {
+            for (std::size_t i = 0; i < cnt; ++i) {
+                y.data[i] = x.data[i] + tiling.offset + extra;
+            }
+        }
+    };
+}
+
+ASL_REGISTER_TILING(OpOffset, OffsetTiling, ComputeOffsetTiling)
+
+SCENARIO("Test tiling computed once per shape and shared by blocks") {
+    STATIC_REQUIRE(KernelTiling<OpScale>::ENABLED);
+    STATIC_REQUIRE_FALSE(KernelTiling<int>::ENABLED);
+
+    std::size_t count = 1024;
+    std::vector<float> inputs(count, 1.0f);
+    std::vector<float> outputs(count, 0.0f);
+    Addr in = reinterpret_cast<Addr>(inputs.data());
+    Addr out = reinterpret_cast<Addr>(outputs.data());
+
+    ScaleKernel kernel;
+    OpScale::TilingCalls() = 0;
+    ResetObservations();
+    kernel.Run(in, out, count);
+    REQUIRE(OpScale::TilingCalls() == 1);
+    RequireObservations(256);
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(outputs[i] == 3.0f + static_cast<float>(i / 256));
+    }
+
+    ThreadPool pool(2);
+    kernel.RunParallel(pool, 4, in, out, count);
+    ResetObservations();
+    kernel.RunParallel(pool, 4, in, out, count);
+    REQUIRE(OpScale::TilingCalls() == 2);
+    REQUIRE(outputs[1023] == 6.0f);
+    RequireObservations(256);
+
+    ResetObservations();
+    kernel.RunParallel(pool, 4, in, out, count / 2);
+    REQUIRE(OpScale::TilingCalls() == 3);
+    RequireObservations(128);
+    REQUIRE(GetBlockIdx() == 0);
+    REQUIRE(GetBlockNum() == 1);
+}
+
+SCENARIO("Test tiling function registered by macro") {
+    STATIC_REQUIRE(KernelTiling<OpOffset>::ENABLED);
+
+    std::vector<int> inputs(10, 1);
+    std::vector<int> outputs(10, 0);
+    ElemWise<OpOffset, Input<int>, Output<int>> kernel;
+    kernel.Run(reinterpret_cast<Addr>(inputs.data()), reinterpret_cast<Addr>(outputs.data()), 10, 5);
+    REQUIRE(outputs[0] == 16);
+    REQUIRE(outputs[9] == 16);
+}
+
+SCENARIO("Test block scope nests") {
+    BlockScope outer(2, 8);
+    REQUIRE(GetBlockIdx() == 2);
+    {
+        BlockScope inner(1, 3);
+        REQUIRE(GetBlockNum() == 3);
+    }
+    REQUIRE(GetBlockIdx() == 2);
+    REQUIRE(GetBlockNum() == 8);
+}
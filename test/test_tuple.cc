@@ -1,8 +1,11 @@
 #include "catch2/catch.hpp"
 #include "tuple.h"
+#include "parallel.h"
 #include "index_seq.h"
 #include "type_list.h"
 #include <iostream>
+#include <string>
+#include <vector>
 
 using namespace asl;
 
@@ -51,8 +54,7 @@ void ProcessTypeListImpl(IndexSequence<Is...>) {
     Tuple< Tensor<typename TypeList_Get<List, Is>::type>...> tensors;
     
     // 初始化每个 Tensor
-    int dummy[] = { 0, (InitTensor(TupleElemGet<Is>(tensors), Is), 0)... };
-    (void)dummy; // 避免未使用变量警告
+    TupleForEach(tensors, [](auto& tensor, std::size_t index) { InitTensor(tensor, index); });
     
     // 传递所有初始化后的 Tensor 给 HandleAllTensors
     HandleAllTensors(TupleElemGet<Is>(tensors)...);
@@ -71,4 +73,110 @@ struct TypeC {};
 SCENARIO("Test tuple generation") {
     using InputTypes = TypeList<TypeA, TypeB, TypeC>;
     ProcessTypeList<InputTypes>();
-}
\ No newline at end of file
+}
+/////////////////////////////////////////////////////////////////////////////////////
+// 记录拷贝与移动次数的测试类型
+struct CopyCounter {
+    static int copies;
+    static int moves;
+
+    CopyCounter() = default;
+    CopyCounter(int v, char c) : value(v + c) {}
+    CopyCounter(const CopyCounter& other) : value(other.value) { ++copies; }
+    CopyCounter(CopyCounter&& other) : value(other.value) { ++moves; }
+
+    int value{0};
+};
+
+int CopyCounter::copies = 0;
+int CopyCounter::moves = 0;
+
+SCENARIO("Test tuple converting constructors") {
+    std::string log = "hello";
+    Tuple<std::string, long, double> tuple(log, 3, 1.5f);
+    REQUIRE(TupleElemGet<0>(tuple) == "hello");
+    REQUIRE(TupleElemGet<1>(tuple) == 3L);
+    REQUIRE(TupleElemGet<2>(tuple) == 1.5);
+
+    Tuple<std::string, long long, double> converted(tuple);
+    REQUIRE(TupleElemGet<0>(converted) == "hello");
+    REQUIRE(TupleElemGet<1>(converted) == 3LL);
+
+    Tuple<std::string> single("world");
+    REQUIRE(TupleElemGet<0>(single) == "world");
+}
+
+SCENARIO("Test tuple piecewise construction") {
+    CopyCounter::copies = 0;
+    CopyCounter::moves = 0;
+
+    Tuple<CopyCounter, std::string> tuple(PIECEWISE_CONSTRUCT, ForwardAsTuple(1, 'a'), ForwardAsTuple(3, 'x'));
+    REQUIRE(TupleElemGet<0>(tuple).value == 1 + 'a');
+    REQUIRE(TupleElemGet<1>(tuple) == "xxx");
+    REQUIRE(CopyCounter::copies == 0);
+    REQUIRE(CopyCounter::moves == 0);
+}
+
+SCENARIO("Test tuple apply without copies") {
+    CopyCounter::copies = 0;
+    CopyCounter::moves = 0;
+
+    CopyCounter counter(1, 'a');
+    const std::string log = "hello";
+    int n = 3;
+    auto args = ForwardAsTuple(counter, log, std::move(n));
+
+    auto result = TupleApply([](const CopyCounter& c, const std::string& s, int n) {
+        return c.value + static_cast<int>(s.size()) + n;
+    }, args);
+    REQUIRE(result == 1 + 'a' + 5 + 3);
+    REQUIRE(CopyCounter::copies == 0);
+
+    Tuple<CopyCounter> owned(PIECEWISE_CONSTRUCT, ForwardAsTuple(2, 'b'));
+    CopyCounter moved = TupleApply([](CopyCounter&& c) { return CopyCounter(std::move(c)); }, std::move(owned));
+    REQUIRE(moved.value == 2 + 'b');
+    REQUIRE(CopyCounter::copies == 0);
+    REQUIRE(CopyCounter::moves == 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+SCENARIO("Test tuple for each and transform") {
+    Tuple<int, double, std::string> tuple(1, 2.5, "abc");
+
+    std::size_t visited = 0;
+    TupleForEach(tuple, [&visited](auto&, std::size_t index) {
+        REQUIRE(index == visited);
+        ++visited;
+    });
+    REQUIRE(visited == 3);
+
+    TupleForEach(tuple, [](auto& elem) { elem = elem + elem; });
+    REQUIRE(TupleElemGet<0>(tuple) == 2);
+    REQUIRE(TupleElemGet<1>(tuple) == 5.0);
+    REQUIRE(TupleElemGet<2>(tuple) == "abcabc");
+
+    auto sizes = TupleTransform(tuple, [](const auto& elem) { return sizeof(elem); });
+    static_assert(std::is_same_v<decltype(sizes), Tuple<std::size_t, std::size_t, std::size_t>>, "sizes should be size_t");
+    REQUIRE(TupleElemGet<0>(sizes) == sizeof(int));
+    REQUIRE(TupleElemGet<1>(sizes) == sizeof(double));
+
+    auto tagged = TupleTransform(tuple, [](const auto&, auto index) { return index * 10; });
+    REQUIRE(TupleElemGet<2>(tagged) == 20);
+}
+
+SCENARIO("Test parallel tuple for each") {
+    ThreadPool pool(3);
+    Tuple<std::vector<int>, std::vector<float>, std::vector<char>, std::vector<double>> buffers;
+
+    ParallelTupleForEach(pool, buffers, [](auto& buffer, std::size_t index) {
+        buffer.assign(1000 + index, static_cast<typename std::decay_t<decltype(buffer)>::value_type>(index + 1));
+    });
+
+    REQUIRE(TupleElemGet<0>(buffers).size() == 1000);
+    REQUIRE(TupleElemGet<3>(buffers).size() == 1003);
+    REQUIRE(TupleElemGet<1>(buffers).back() == 2.0f);
+    REQUIRE(TupleElemGet<2>(buffers).front() == 3);
+
+    Tuple<> empty;
+    ParallelTupleForEach(pool, empty, [](auto&) {});
+}
@@ -1,6 +1,8 @@
 #include "catch2/catch.hpp"
 #include "type_list.h"
 #include "forward.h"
+#include "parallel.h"
+#include <atomic>
 #include <type_traits>
 #include <iostream>
 
@@ -129,4 +131,92 @@ struct CreateAndCallRec<TypeList<Head, Tail...>, Func, Args...> {
 SCENARIO("Test type list for pass variables to function") {
     using MyTypes = TypeList<int, char, double>;
     CreateAndCallRec<MyTypes, ShowParams>::execute(ShowParams{});
-}
\ No newline at end of file
+}
+/////////////////////////////////////////////////////////////////////////////////////
+SCENARIO("Test type list meta function with concat, contains and index of") {
+    using Concated = TypeList_Concat<TypeList<int>, TypeList<>, TypeList<char, double>>::type;
+    static_assert(std::is_same_v<Concated, TypeList<int, char, double>>, "Concated should contain int, char, double");
+    static_assert(std::is_same_v<TypeList_Concat<>::type, TypeList<>>, "Concat of nothing should be empty");
+
+    static_assert(TypeList_Contains<Concated, char>::value, "Concated should contain char");
+    static_assert(!TypeList_Contains<Concated, float>::value, "Concated should not contain float");
+
+    static_assert(TypeList_IndexOf<Concated, int>::value == 0, "int should be at 0");
+    static_assert(TypeList_IndexOf<Concated, double>::value == 2, "double should be at 2");
+    static_assert(TypeList_IndexOf<TypeList<int, char, int>, int>::value == 0, "first int should be found");
+}
+
+SCENARIO("Test type list meta function with unique and zip") {
+    using Uniqued = TypeList_Unique<TypeList<int, char, int, double, char>>::type;
+    static_assert(std::is_same_v<Uniqued, TypeList<int, char, double>>, "Uniqued should keep first occurrences");
+    static_assert(std::is_same_v<TypeList_Unique<TypeList<>>::type, TypeList<>>, "Unique of empty should be empty");
+
+    using Zipped = TypeList_Zip<TypeList<int, char>, TypeList<float, double>>::type;
+    static_assert(std::is_same_v<Zipped, TypeList<TypeList<int, float>, TypeList<char, double>>>, "Zipped should pair types");
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+template <typename A, typename B>
+struct SizeLess {
+    static constexpr bool value = sizeof(A) < sizeof(B);
+};
+
+SCENARIO("Test type list meta function with sort") {
+    static_assert(std::is_same_v<TypeList_Sort<TypeList<>, SizeLess>::type, TypeList<>>, "Empty list stays empty");
+    static_assert(std::is_same_v<TypeList_Sort<TypeList<int>, SizeLess>::type, TypeList<int>>, "Single list stays");
+
+    using Sorted = TypeList_Sort<TypeList<double, char, int, short, long long>, SizeLess>::type;
+    static_assert(std::is_same_v<Sorted, TypeList<char, short, int, double, long long>>, "Sorted should be stable by size");
+
+    using ByLayout = TypeList_Sort<TypeList<char, double, char[3], int, short, unsigned char, float>, TypeLayoutGreater>::type;
+    static_assert(std::is_same_v<ByLayout, TypeList<double, int, float, short, char[3], char, unsigned char>>,
+                  "ByLayout should be sorted by alignment then size");
+
+    using Wide = TypeList<char, short, int, double, char, short, int, double, char, short, int, double,
+                          char, short, int, double, char, short, int, double, char, short, int, double>;
+    using WideSorted = TypeList_Sort<Wide, TypeAlignGreater>::type;
+    static_assert(std::is_same_v<TypeList_Get<WideSorted, 5>::type, double>, "first six should be double");
+    static_assert(std::is_same_v<TypeList_Get<WideSorted, 6>::type, int>, "then int");
+    static_assert(std::is_same_v<TypeList_Get<WideSorted, 23>::type, char>, "char should be last");
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+SCENARIO("Test type list for all byte offsets computed at once") {
+    using InputTypes = TypeList<char, double, short, int>;
+    constexpr auto offsets = TypeList_ByteOffsets<InputTypes>::value;
+
+    static_assert(offsets[0] == 0, "Offset of char should be 0");
+    static_assert(offsets[1] == sizeof(char), "Offset of double should be sizeof(char)");
+    static_assert(offsets[3] == sizeof(char) + sizeof(double) + sizeof(short), "Offset of int should follow short");
+    static_assert(TypeList_ByteOffsets<InputTypes>::total == 15, "Total bytes should be 15");
+    static_assert(TypeList_ByteOffsets<TypeList<>>::total == 0, "Total bytes of empty list should be 0");
+    static_assert(TypeList_ByteOffset<InputTypes, 2>::value == offsets[2], "ByteOffset should read from ByteOffsets");
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 记录每个类型的预热结果
+std::atomic<std::size_t> warmedSizes[8];
+
+template <typename T, size_t Index>
+struct WarmupType {
+    static void execute() {
+        warmedSizes[Index] += sizeof(T);
+    }
+};
+
+SCENARIO("Test type list meta function with parallel apply") {
+    ThreadPool pool(3);
+    TypeList_ParallelApply<TypeList<>, WarmupType>::execute(pool);
+
+    using InputTypes = TypeList<char, short, int, double, long long, float>;
+    TypeList_ParallelApply<InputTypes, WarmupType>::execute(pool);
+
+    REQUIRE(warmedSizes[0] == sizeof(char));
+    REQUIRE(warmedSizes[3] == sizeof(double));
+    REQUIRE(warmedSizes[5] == sizeof(float));
+    REQUIRE(warmedSizes[6] == 0);
+
+    TypeList_ParallelApply<TypeList<int, int>, WarmupType, 6>::execute(pool);
+    REQUIRE(warmedSizes[6] == sizeof(int));
+    REQUIRE(warmedSizes[7] == sizeof(int));
+}
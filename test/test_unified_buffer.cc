@@ -0,0 +1,121 @@
+#include "catch2/catch.hpp"
+#include "autotuner.h"
+#include "elem_wise.h"
+#include "thread_pool.h"
+#include "unified_buffer.h"
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    // 按 AscendC 的 CopyIn -> Compute -> CopyOut 写法：输入搬到 UB 计算后再搬回
+    struct OpStagedAdd {
+        void operator()(Tensor<float> x, Tensor<float> y, Tensor<float> z, Tensor<float> tmp, std::size_t cnt) const {
+            LocalTensor<float> xLocal = AllocLocal<float>(cnt);
+            LocalTensor<float> yLocal = AllocLocal<float>(cnt);
+            DataCopy(xLocal, x, cnt);
+            DataCopy(yLocal, y, cnt);
+            for (std::size_t i = 0; i < cnt; ++i) {
+                tmp.data[i] = xLocal[i] + yLocal[i];
+            }
+            LocalTensor<float> zLocal{tmp.data, tmp.size};
+            DataCopy(z, zLocal, cnt);
+        }
+    };
+
+    using StagedAddKernel = ElemWise<OpStagedAdd, Input<float, float>, Output<float>, Temp<float>>;
+
+    struct CapacityGuard {
+        explicit CapacityGuard(std::size_t bytes) {
+            UnifiedBuffer::SetCapacity(bytes);
+        }
+        ~CapacityGuard() {
+            UnifiedBuffer::SetCapacity(UB_DEFAULT_CAPACITY);
+        }
+    };
+}
+
+SCENARIO("Test unified buffer allocation and scope") {
+    CapacityGuard guard(1024);
+    UnifiedBuffer& ub = UnifiedBuffer::Current();
+    REQUIRE(ub.Size() == 1024);
+    REQUIRE(ub.Used() == 0);
+
+    {
+        UbScope scope;
+        LocalTensor<char> a = ub.AllocTensor<char>(3);
+        LocalTensor<double> b = ub.AllocTensor<double>(10);
+        REQUIRE(a.size == 3);
+        REQUIRE(b.Count() == 10);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(a.data) % UB_ALIGN == 0);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(b.data) % UB_ALIGN == 0);
+        REQUIRE(ub.Used() == 32 + 96);
+
+        REQUIRE_THROWS_AS(ub.Allocate(1024), UbOverflowError);
+        REQUIRE(ub.Used() == 32 + 96);
+    }
+    REQUIRE(ub.Used() == 0);
+    REQUIRE(ub.Peak() >= 128);
+}
+
+SCENARIO("Test data copy between global memory and unified buffer") {
+    std::vector<int> global{1, 2, 3, 4};
+    Tensor<int> gm{global.data(), global.size() * sizeof(int)};
+
+    UbScope scope;
+    UnifiedBuffer::Current().ResetStats();
+    LocalTensor<int> local = AllocLocal<int>(4);
+    DataCopy(local, gm, 4);
+    local[0] = 10;
+    DataCopy(gm, local, 2);
+
+    REQUIRE(global[0] == 10);
+    REQUIRE(global[1] == 2);
+    REQUIRE(UnifiedBuffer::Current().CopyInBytes() == 16);
+    REQUIRE(UnifiedBuffer::Current().CopyOutBytes() == 8);
+    REQUIRE_THROWS_AS(DataCopy(local, gm, 5), std::out_of_range);
+}
+
+SCENARIO("Test executor enforces unified buffer budget") {
+    std::size_t count = 4096;
+    std::vector<float> inputs(count * 2, 1.0f);
+    std::vector<float> outputs(count, 0.0f);
+    Addr in = reinterpret_cast<Addr>(inputs.data());
+    Addr out = reinterpret_cast<Addr>(outputs.data());
+    StagedAddKernel kernel;
+
+    GIVEN("the default capacity") {
+        kernel.Run(in, in, out, count);
+        REQUIRE(outputs[0] == 2.0f);
+        REQUIRE(outputs[count - 1] == 2.0f);
+        REQUIRE(UnifiedBuffer::Current().Used() == 0);
+    }
+
+    GIVEN("a capacity too small for the temps of a whole block") {
+        CapacityGuard guard(8 * 1024);
+        REQUIRE_THROWS_AS(kernel.Run(in, in, out, count), UbOverflowError);
+
+        ThreadPool pool(2);
+        THEN("tiling keeps temps and staged tiles in the budget") {
+            kernel.RunWithConfig(LaunchConfig{&pool, 2, LaunchSchedule::STATIC, 512}, in, in, out, count);
+            REQUIRE(outputs[count - 1] == 2.0f);
+        }
+
+        THEN("temps fit but the staged inputs overflow inside the block") {
+            REQUIRE(StagedAddKernel::UbTempBytes(1024) <= 8 * 1024);
+            REQUIRE_THROWS_AS(kernel.RunWithConfig(LaunchConfig{&pool, 2, LaunchSchedule::STATIC, 1024}, in, in, out, count),
+                              UbOverflowError);
+        }
+
+        THEN("autotuner skips candidates that do not fit") {
+            Autotuner tuner;
+            TuneCandidates candidates;
+            candidates.blockDims = {1, 2};
+            candidates.tileSizes = {0, 256};
+            candidates.repeat = 1;
+            TunedConfig best = tuner.Tune<StagedAddKernel>(pool, count, candidates);
+            REQUIRE(best.tileSize == 256);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <vector>
+#include "kernel.h"
+#include "vector_ops.h"
+
+namespace asl {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// 各测试共用的辅助：取 vector 的 GM 地址（空 vector 为 nullptr），以及在作用域内切换向量指令集
+template <typename T>
+Addr AddrOf(std::vector<T>& values) {
+    return values.empty() ? nullptr : reinterpret_cast<Addr>(values.data());
+}
+
+class IsaGuard {
+public:
+    explicit IsaGuard(IsaVariant isa) : saved_(VectorIsa()) {
+        SetVectorIsa(isa);
+    }
+
+    ~IsaGuard() {
+        SetVectorIsa(saved_);
+    }
+
+    IsaGuard(const IsaGuard&) = delete;
+    IsaGuard& operator=(const IsaGuard&) = delete;
+
+private:
+    IsaVariant saved_;
+};
+
+}
+
+#endif
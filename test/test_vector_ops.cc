@@ -0,0 +1,170 @@
+#include "catch2/catch.hpp"
+#include "vector_ops.h"
+#include "test_util.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace asl;
+
+/////////////////////////////////////////////////////////////////////////////////////
+namespace {
+    template <typename T>
+    LocalTensor<T> LocalOf(std::vector<T>& values) {
+        return LocalTensor<T>{values.data(), values.size() * sizeof(T)};
+    }
+}
+
+SCENARIO("Test vector instructions on every isa") {
+    auto isa = GENERATE(IsaVariant::SCALAR, IsaVariant::AVX2, IsaVariant::AVX512);
+    IsaGuard guard(isa);
+    REQUIRE(VectorIsa() <= DetectIsa());
+
+    std::size_t count = 1003;
+    std::vector<float> a(count), b(count), z(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        a[i] = static_cast<float>(i % 97) - 48.0f;
+        b[i] = static_cast<float>(i % 13) + 1.0f;
+    }
+    auto x = LocalOf(a), y = LocalOf(b), dst = LocalOf(z);
+
+    Add(dst, x, y, count);
+    REQUIRE(z[count - 1] == a[count - 1] + b[count - 1]);
+    Sub(dst, x, y, count);
+    REQUIRE(z[500] == a[500] - b[500]);
+    Mul(dst, x, y, count);
+    REQUIRE(z[17] == a[17] * b[17]);
+    Div(dst, x, y, count);
+    REQUIRE(z[999] == a[999] / b[999]);
+    Max(dst, x, y, count);
+    Min(dst, dst, y, count);
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(z[i] == b[i]);
+    }
+
+    Adds(dst, x, 2.5f, count);
+    REQUIRE(z[1002] == a[1002] + 2.5f);
+    Muls(dst, x, -2.0f, count);
+    REQUIRE(z[3] == a[3] * -2.0f);
+    Maxs(dst, x, 0.0f, count);
+    Mins(dst, dst, 10.0f, count);
+    REQUIRE(z[0] == 0.0f);
+    REQUIRE(z[96] == 10.0f);
+
+    Abs(dst, x, count);
+    REQUIRE(z[0] == 48.0f);
+    Relu(dst, x, count);
+    REQUIRE(z[0] == 0.0f);
+    REQUIRE(z[60] == 12.0f);
+    Sqrt(dst, y, count);
+    REQUIRE(z[3] == Approx(2.0f));
+
+    for (std::size_t i = 0; i < count; ++i) {
+        a[i] = -80.0f + 160.0f * i / count;
+    }
+    Exp(dst, x, count);
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(z[i] == Approx(std::exp(a[i])).epsilon(2e-6));
+    }
+
+    // 超出多项式区间的输入与标量 std::exp 一致：NaN 透传、下溢冲零、上溢为 inf
+    float inf = std::numeric_limits<float>::infinity();
+    float specials[] = {std::numeric_limits<float>::quiet_NaN(), -inf, -100.0f, -87.5f, 89.0f, inf};
+    std::vector<float> edges(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        edges[i] = specials[i % 6];
+    }
+    Exp(dst, LocalOf(edges), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (std::isnan(edges[i])) {
+            REQUIRE(std::isnan(z[i]));
+        } else if (edges[i] < 0.0f) {
+            REQUIRE(z[i] == Approx(std::exp(edges[i])).margin(1e-37));
+        } else {
+            REQUIRE(z[i] == inf);
+        }
+    }
+
+    std::vector<float> out(1), work(count);
+    std::vector<float> ones(count, 0.5f);
+    ReduceSum(LocalOf(out), LocalOf(ones), LocalOf(work), count);
+    REQUIRE(out[0] == Approx(0.5 * count));
+    ReduceMax(LocalOf(out), x, LocalOf(work), count);
+    REQUIRE(out[0] == a[count - 1]);
+    ReduceMax(LocalOf(out), x, LocalOf(work), 5);
+    REQUIRE(out[0] == a[4]);
+}
+
+SCENARIO("Test vector instructions with mask and repeat") {
+    std::vector<float> a(256, 1.0f), b(256, 2.0f), z(256, 0.0f);
+    auto x = LocalOf(a), y = LocalOf(b), dst = LocalOf(z);
+
+    GIVEN("a continuous mask") {
+        // 每次迭代 64 个 float，只计算前 40 个
+        Add(dst, x, y, 40, 2, BinaryRepeatParams());
+        REQUIRE(z[0] == 3.0f);
+        REQUIRE(z[39] == 3.0f);
+        REQUIRE(z[40] == 0.0f);
+        REQUIRE(z[64] == 3.0f);
+        REQUIRE(z[104] == 0.0f);
+        REQUIRE(z[128] == 0.0f);
+    }
+
+    GIVEN("a full mask over dense repeats") {
+        Muls(dst, y, 3.0f, 64, 4, UnaryRepeatParams());
+        REQUIRE(z[0] == 6.0f);
+        REQUIRE(z[255] == 6.0f);
+    }
+
+    GIVEN("a bitwise mask") {
+        std::uint64_t mask[2] = {0x5555555555555555ull, 0};
+        Exp(dst, x, mask, 1, UnaryRepeatParams());
+        REQUIRE(z[0] == Approx(std::exp(1.0f)));
+        REQUIRE(z[1] == 0.0f);
+        REQUIRE(z[62] == Approx(std::exp(1.0f)));
+        REQUIRE(z[63] == 0.0f);
+    }
+
+    GIVEN("block and repeat strides") {
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            a[i] = static_cast<float>(i);
+        }
+        // dst 的 datablock 间隔 2 个 datablock，相邻迭代间隔 16 个；src 连续
+        BinaryRepeatParams params;
+        params.dstBlkStride = 2;
+        params.dstRepStride = 16;
+        Add(dst, x, y, 64, 2, params);
+        REQUIRE(z[0] == 2.0f);
+        REQUIRE(z[7] == 9.0f);
+        REQUIRE(z[8] == 0.0f);
+        REQUIRE(z[16] == 10.0f);
+        REQUIRE(z[128] == 66.0f);
+        REQUIRE(z[240] == 122.0f);
+        REQUIRE(z[247] == 129.0f);
+        REQUIRE(z[248] == 0.0f);
+        REQUIRE_THROWS_AS(Add(dst, x, y, 64, 3, params), std::out_of_range);
+    }
+
+    REQUIRE_THROWS_AS(Add(dst, x, y, 0, 1, BinaryRepeatParams()), std::invalid_argument);
+    REQUIRE_THROWS_AS(Add(dst, x, y, 65, 1, BinaryRepeatParams()), std::invalid_argument);
+    REQUIRE_THROWS_AS(Add(dst, x, y, 257), std::out_of_range);
+}
+
+SCENARIO("Test vector instructions on other types and op accounting") {
+    std::vector<std::int32_t> a{1, -2, 3, -4, 5}, b{5, 4, 3, 2, 1}, z(5);
+    auto x = LocalOf(a), y = LocalOf(b), dst = LocalOf(z);
+
+    UnifiedBuffer::Current().ResetStats();
+    Max(dst, x, y, 5);
+    REQUIRE(z == std::vector<std::int32_t>{5, 4, 3, 2, 5});
+    Abs(dst, x, 5);
+    REQUIRE(z == std::vector<std::int32_t>{1, 2, 3, 4, 5});
+    Duplicate(dst, 7, 3);
+    REQUIRE(z == std::vector<std::int32_t>{7, 7, 7, 4, 5});
+    std::vector<std::int32_t> wide(64, 0);
+    Adds(LocalOf(wide), x, 10, 5, 1, UnaryRepeatParams());
+    std::copy(wide.begin(), wide.begin() + 5, z.begin());
+    REQUIRE(z == std::vector<std::int32_t>{11, 8, 13, 6, 15});
+    REQUIRE(UnifiedBuffer::Current().VectorOps() == 5 + 5 + 3 + 5);
+}